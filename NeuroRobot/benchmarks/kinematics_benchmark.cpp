@@ -0,0 +1,283 @@
+#include <NeuroKinematics/NeuroKinematics.hpp>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+// Micro-benchmark of the NeuroKinematics FK/IK methods. Joint values are
+// sampled uniformly inside the hardware joint limits and the IK is evaluated
+// on the entry and target points the FK produces for them. Results are written
+// as JSON to stdout, or to the file given as the first argument. Every method
+// reports a checksum of its results over one sweep of the samples, so a
+// change of the results shows up next to a change of the timings.
+//
+// Usage: kinematics_benchmark [output.json] [no_of_samples]
+
+// Sum of the finite results of a method. Some of the sampled points are out
+// of reach of the IK, which returns NaN joint values for them, those are
+// counted apart.
+struct Checksum
+{
+  double sum        = 0;
+  long   non_finite = 0;
+
+  void add(double value)
+  {
+    if (std::isfinite(value))
+    {
+      sum += value;
+    }
+    else
+    {
+      non_finite++;
+    }
+  }
+  template < typename Derived >
+  void add(const Eigen::DenseBase< Derived >& values)
+  {
+    for (Eigen::Index i = 0; i < values.size(); i++)
+    {
+      add(double(values(i)));
+    }
+  }
+};
+
+struct BenchmarkResult
+{
+  std::string name;
+  long        calls;
+  double      seconds;
+  Checksum    checksum;
+};
+
+// Runs body(i, checksum) over every sample, repeating the sweep until at least
+// min_seconds have elapsed so fast methods are timed over enough calls. The
+// results are added to the checksum during the first, untimed, sweep only, the
+// timed sweeps pass NULL.
+static BenchmarkResult
+  Run(const std::string& name, int no_of_samples, int calls_per_sample,
+      const std::function< void(int, Checksum*) >& body)
+{
+  const double min_seconds = 0.5;
+
+  // Warm up caches and branch predictors
+  Checksum checksum;
+  for (int i = 0; i < no_of_samples; i++)
+  {
+    body(i, &checksum);
+  }
+
+  long   repetitions = 0;
+  double seconds     = 0;
+  auto   start       = std::chrono::steady_clock::now();
+  do
+  {
+    for (int i = 0; i < no_of_samples; i++)
+    {
+      body(i, NULL);
+    }
+    repetitions++;
+    seconds = std::chrono::duration< double >(
+                std::chrono::steady_clock::now() - start)
+                .count();
+  } while (seconds < min_seconds);
+
+  BenchmarkResult result;
+  result.name    = name;
+  result.calls   = repetitions * no_of_samples * calls_per_sample;
+  result.seconds  = seconds;
+  result.checksum = checksum;
+  return result;
+}
+
+int main(int argc, char** argv)
+{
+  const char* output_file   = (argc > 1) ? argv[1] : NULL;
+  const int   no_of_samples = (argc > 2) ? std::atoi(argv[2]) : 4096;
+
+  double _cannulaToTreatment{0.0};
+  double _treatmentToTip{0.0};
+  double _robotToEntry{5.0};
+  double _robotToTreatmentAtHome{41.0};
+  Probe  probe_init = {_cannulaToTreatment, _treatmentToTip, _robotToEntry,
+                      _robotToTreatmentAtHome};
+  NeuroKinematics    NeuroKinematics_(&probe_init);
+  NeuroKinematicsf   NeuroKinematicsf_(NeuroKinematics_);
+  Neuro_joint_limits limits;
+
+  // Joint values inside the joint limits. The feet are sampled relative to the
+  // head so the axial separation stays within its limits as well.
+  Neuro_joint_batch joints;
+  joints.resize(no_of_samples);
+  std::srand(42);
+  for (int i = 0; i < no_of_samples; i++)
+  {
+    double r[7];
+    for (int j = 0; j < 7; j++)
+    {
+      r[j] = std::rand() / ( double ) RAND_MAX;
+    }
+    joints.AxialHeadTranslation(i) =
+      limits.min_axial_head_translation +
+      (limits.max_axial_head_translation - limits.min_axial_head_translation) *
+        r[0];
+    joints.AxialFeetTranslation(i) =
+      joints.AxialHeadTranslation(i) +
+      NeuroKinematics_._initialAxialSeperation - limits.max_axial_separation +
+      (limits.max_axial_separation - limits.min_axial_separation) * r[1];
+    joints.LateralTranslation(i) =
+      limits.min_lateral_translation +
+      (limits.max_lateral_translation - limits.min_lateral_translation) * r[2];
+    joints.ProbeInsertion(i) =
+      limits.min_probe_insertion +
+      (limits.max_probe_insertion - limits.min_probe_insertion) * r[3];
+    joints.ProbeRotation(i) = 2 * M_PI * r[4];
+    joints.PitchRotation(i) =
+      limits.min_pitch_rotation +
+      (limits.max_pitch_rotation - limits.min_pitch_rotation) * r[5];
+    joints.YawRotation(i) =
+      limits.min_yaw_rotation +
+      (limits.max_yaw_rotation - limits.min_yaw_rotation) * r[6];
+  }
+
+  // Entry, target and RCM points of every sample for the IK
+  std::vector< Eigen::Vector4d, Eigen::aligned_allocator< Eigen::Vector4d > >
+    entry_points(no_of_samples), target_points(no_of_samples),
+    rcm_points(no_of_samples);
+  for (int i = 0; i < no_of_samples; i++)
+  {
+    Neuro_FK_frames_outputs FK = NeuroKinematics_.ForwardKinematicsFrames(
+      joints.AxialHeadTranslation(i), joints.AxialFeetTranslation(i),
+      joints.LateralTranslation(i), joints.ProbeInsertion(i),
+      joints.ProbeRotation(i), joints.PitchRotation(i), joints.YawRotation(i));
+    entry_points[i]  = FK.zFrameToEntryPoint.col(3);
+    target_points[i] = FK.zFrameToTreatment.col(3);
+    rcm_points[i]    = FK.zFrameToRCM.col(3);
+  }
+  Eigen::Matrix3Xf target_point_set(3, no_of_samples);
+  for (int i = 0; i < no_of_samples; i++)
+  {
+    target_point_set.col(i) = target_points[i].head< 3 >().cast< float >();
+  }
+
+  // The results are only used for the checksum, which the compiler cannot
+  // tell is NULL in the timed sweeps, so it cannot drop the calls either
+  std::vector< BenchmarkResult > results;
+  results.push_back(
+    Run("ForwardKinematics", no_of_samples, 1, [&](int i, Checksum* checksum) {
+      const double x =
+        NeuroKinematics_
+          .ForwardKinematics(
+            joints.AxialHeadTranslation(i), joints.AxialFeetTranslation(i),
+            joints.LateralTranslation(i), joints.ProbeInsertion(i),
+            joints.ProbeRotation(i), joints.PitchRotation(i),
+            joints.YawRotation(i))
+          .zFrameToTreatment(0, 3);
+      if (checksum != NULL)
+      {
+        checksum->add(x);
+      }
+    }));
+  results.push_back(
+    Run("GetRcm", no_of_samples, 1, [&](int i, Checksum* checksum) {
+      const double x =
+        NeuroKinematics_
+          .GetRcm(joints.AxialHeadTranslation(i),
+                  joints.AxialFeetTranslation(i), joints.LateralTranslation(i),
+                  joints.ProbeInsertion(i), joints.ProbeRotation(i),
+                  joints.PitchRotation(i), joints.YawRotation(i))
+          .zFrameToTreatment(0, 3);
+      if (checksum != NULL)
+      {
+        checksum->add(x);
+      }
+    }));
+  results.push_back(
+    Run("InverseKinematics", no_of_samples, 1, [&](int i, Checksum* checksum) {
+      const double head =
+        NeuroKinematics_.InverseKinematics(entry_points[i], target_points[i])
+          .AxialHeadTranslation;
+      if (checksum != NULL)
+      {
+        checksum->add(head);
+      }
+    }));
+  results.push_back(Run("InverseKinematicsWithZeroProbeInsertion",
+                        no_of_samples, 1, [&](int i, Checksum* checksum) {
+                          const double head =
+                            NeuroKinematics_
+                              .InverseKinematicsWithZeroProbeInsertion(
+                                entry_points[i], rcm_points[i])
+                              .AxialHeadTranslation;
+                          if (checksum != NULL)
+                          {
+                            checksum->add(head);
+                          }
+                        }));
+
+  // The batched methods are timed per configuration so they can be compared
+  // with the scalar ones. Each body call evaluates the whole batch.
+  Eigen::Matrix3Xf  treatment_positions;
+  Neuro_joint_batch ik_joints;
+  results.push_back(Run("ForwardKinematicsBatch<float>", 1, no_of_samples,
+                        [&](int, Checksum* checksum) {
+                          NeuroKinematicsf_.ForwardKinematicsBatch(
+                            joints, treatment_positions);
+                          if (checksum != NULL)
+                          {
+                            checksum->add(treatment_positions.row(0));
+                          }
+                        }));
+  results.push_back(Run("InverseKinematicsBatch<float>", 1, no_of_samples,
+                        [&](int, Checksum* checksum) {
+                          NeuroKinematicsf_.InverseKinematicsBatch(
+                            entry_points[0].cast< float >(), target_point_set,
+                            ik_joints);
+                          if (checksum != NULL)
+                          {
+                            checksum->add(ik_joints.AxialHeadTranslation);
+                          }
+                        }));
+
+  std::ostringstream json;
+  json << "{\n"
+       << "  \"benchmark\": \"kinematics\",\n"
+       << "  \"samples\": " << no_of_samples << ",\n"
+       << "  \"results\": [\n";
+  for (size_t i = 0; i < results.size(); i++)
+  {
+    const BenchmarkResult& result = results[i];
+    json << "    {\"name\": \"" << result.name << "\", "
+         << "\"calls\": " << result.calls << ", "
+         << "\"seconds\": " << result.seconds << ", "
+         << "\"ns_per_call\": " << result.seconds * 1e9 / result.calls << ", "
+         << "\"calls_per_second\": " << result.calls / result.seconds << ", "
+         << "\"checksum\": " << std::setprecision(15) << result.checksum.sum
+         << std::setprecision(6) << ", "
+         << "\"non_finite\": " << result.checksum.non_finite << "}"
+         << ((i + 1 < results.size()) ? ",\n" : "\n");
+  }
+  json << "  ]\n"
+       << "}\n";
+
+  if (output_file != NULL)
+  {
+    std::ofstream file(output_file);
+    if (!file)
+    {
+      std::cerr << "Could not open " << output_file << std::endl;
+      return 1;
+    }
+    file << json.str();
+  }
+  else
+  {
+    std::cout << json.str();
+  }
+  return 0;
+}
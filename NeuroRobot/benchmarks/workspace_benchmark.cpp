@@ -0,0 +1,401 @@
+#include <NeuroKinematics/NeuroKinematics.hpp>
+#include <WorkspaceVisualization/WorkspaceVisualization.hpp>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <vector>
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+// End-to-end benchmark of the workspace generation for fixed probe
+// configurations and entry points. Every case records its wall time, the
+// process peak memory once it has run and the number of points produced. The
+// geometry of every point set is summarized by an order independent signature
+// and compared against a golden file, so a faster generator cannot silently
+// change the workspaces. Results are written as JSON to stdout or to --output.
+//
+// Usage: workspace_benchmark [--output results.json] [--golden file]
+//                            [--update-golden] [--repetitions n]
+
+#ifndef NEUROROBOT_BENCHMARK_DIR
+#define NEUROROBOT_BENCHMARK_DIR "."
+#endif
+
+// Positions in the golden file are compared to within a micrometer
+static const double kGoldenTolerance = 1e-3;
+
+struct PointSetSignature
+{
+  long   count;
+  double mean[3];
+  double rms[3];
+  double min[3];
+  double max[3];
+};
+
+struct BenchmarkCase
+{
+  std::string       name;
+  double            seconds;
+  long              peak_rss_kb;
+  int               status;
+  PointSetSignature signature;
+};
+
+struct ProbeConfiguration
+{
+  std::string name;
+  Probe       probe;
+};
+
+// Joint values of the entry points each sub-workspace is generated for
+struct EntryPointConfiguration
+{
+  std::string name;
+  double      axial_head;
+  double      axial_feet;
+  double      lateral;
+  double      pitch_degree;
+  double      yaw_degree;
+};
+
+static PointSetSignature ComputeSignature(const Eigen::Matrix3Xf& point_set)
+{
+  PointSetSignature signature;
+  signature.count = point_set.cols();
+  for (int axis = 0; axis < 3; axis++)
+  {
+    if (signature.count == 0)
+    {
+      signature.mean[axis] = signature.rms[axis] = 0;
+      signature.min[axis] = signature.max[axis] = 0;
+      continue;
+    }
+    const Eigen::ArrayXd values = point_set.row(axis).cast< double >();
+    signature.mean[axis]        = values.mean();
+    signature.rms[axis]         = std::sqrt(values.square().mean());
+    signature.min[axis]         = values.minCoeff();
+    signature.max[axis]         = values.maxCoeff();
+  }
+  return signature;
+}
+
+static bool MatchesSignature(const PointSetSignature& signature,
+                             const PointSetSignature& golden)
+{
+  if (signature.count != golden.count)
+  {
+    return false;
+  }
+  for (int axis = 0; axis < 3; axis++)
+  {
+    if (std::abs(signature.mean[axis] - golden.mean[axis]) > kGoldenTolerance ||
+        std::abs(signature.rms[axis] - golden.rms[axis]) > kGoldenTolerance ||
+        std::abs(signature.min[axis] - golden.min[axis]) > kGoldenTolerance ||
+        std::abs(signature.max[axis] - golden.max[axis]) > kGoldenTolerance)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Peak resident set size of the process in kB, or -1 where unsupported
+static long PeakMemoryKb()
+{
+#if defined(__unix__) || defined(__APPLE__)
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0)
+  {
+    return -1;
+  }
+#if defined(__APPLE__)
+  return usage.ru_maxrss / 1024;  // bytes on macOS
+#else
+  return usage.ru_maxrss;
+#endif
+#else
+  return -1;
+#endif
+}
+
+// Golden file format: one case per line,
+// <name> <count> <mean xyz> <rms xyz> <min xyz> <max xyz>
+static bool ReadGoldenFile(const std::string&                         file_name,
+                           std::map< std::string, PointSetSignature >& golden)
+{
+  std::ifstream file(file_name);
+  if (!file)
+  {
+    return false;
+  }
+  std::string line;
+  while (std::getline(file, line))
+  {
+    if (line.empty() || line[0] == '#')
+    {
+      continue;
+    }
+    std::istringstream stream(line);
+    std::string        name;
+    PointSetSignature  signature;
+    stream >> name >> signature.count;
+    for (double* values :
+         {signature.mean, signature.rms, signature.min, signature.max})
+    {
+      stream >> values[0] >> values[1] >> values[2];
+    }
+    if (!stream.fail())
+    {
+      golden[name] = signature;
+    }
+  }
+  return true;
+}
+
+static bool WriteGoldenFile(const std::string&                  file_name,
+                            const std::vector< BenchmarkCase >& cases)
+{
+  std::ofstream file(file_name);
+  if (!file)
+  {
+    return false;
+  }
+  file << "# Point set signatures of workspace_benchmark\n"
+       << "# <name> <count> <mean xyz> <rms xyz> <min xyz> <max xyz>\n"
+       << std::fixed << std::setprecision(6);
+  for (const BenchmarkCase& benchmark_case : cases)
+  {
+    const PointSetSignature& signature = benchmark_case.signature;
+    file << benchmark_case.name << " " << signature.count;
+    for (const double* values :
+         {signature.mean, signature.rms, signature.min, signature.max})
+    {
+      file << " " << values[0] << " " << values[1] << " " << values[2];
+    }
+    file << "\n";
+  }
+  return true;
+}
+
+// Runs the generator the given number of times and keeps the fastest run
+static BenchmarkCase Run(const std::string& name, int repetitions,
+                         const std::function< int(Eigen::Matrix3Xf&) >& body)
+{
+  BenchmarkCase    benchmark_case;
+  Eigen::Matrix3Xf point_set;
+  benchmark_case.name    = name;
+  benchmark_case.seconds = std::numeric_limits< double >::infinity();
+  for (int i = 0; i < repetitions; i++)
+  {
+    auto start            = std::chrono::steady_clock::now();
+    benchmark_case.status = body(point_set);
+    benchmark_case.seconds =
+      std::min(benchmark_case.seconds,
+               std::chrono::duration< double >(
+                 std::chrono::steady_clock::now() - start)
+                 .count());
+  }
+  benchmark_case.peak_rss_kb = PeakMemoryKb();
+  benchmark_case.signature   = ComputeSignature(point_set);
+  std::cerr << name << ": " << point_set.cols() << " points in "
+            << benchmark_case.seconds << " s" << std::endl;
+  return benchmark_case;
+}
+
+int main(int argc, char** argv)
+{
+  std::string output_file;
+  std::string golden_file =
+    std::string(NEUROROBOT_BENCHMARK_DIR) + "/golden/workspace_signatures.txt";
+  bool update_golden = false;
+  int  repetitions   = 1;
+  for (int i = 1; i < argc; i++)
+  {
+    if (!std::strcmp(argv[i], "--output") && i + 1 < argc)
+    {
+      output_file = argv[++i];
+    }
+    else if (!std::strcmp(argv[i], "--golden") && i + 1 < argc)
+    {
+      golden_file = argv[++i];
+    }
+    else if (!std::strcmp(argv[i], "--update-golden"))
+    {
+      update_golden = true;
+    }
+    else if (!std::strcmp(argv[i], "--repetitions") && i + 1 < argc)
+    {
+      repetitions = std::max(1, std::atoi(argv[++i]));
+    }
+    else
+    {
+      std::cerr << "Usage: " << argv[0]
+                << " [--output results.json] [--golden file]"
+                   " [--update-golden] [--repetitions n]"
+                << std::endl;
+      return 1;
+    }
+  }
+
+  // {_cannulaToTreatment, _treatmentToTip, _robotToEntry,
+  // _robotToTreatmentAtHome}
+  const std::vector< ProbeConfiguration > probes = {
+    {"default_probe", {0.0, 0.0, 5.0, 41.0}},
+    {"long_probe", {5.0, 2.0, 10.0, 60.0}},
+  };
+  // {name, axial head, axial feet, lateral, pitch, yaw}
+  const std::vector< EntryPointConfiguration > entry_points = {
+    {"ep_center", -72.0, -40.0, -73.0, -5.0, -44.0},
+    {"ep_anterior", -30.0, -10.0, -60.0, 10.0, -20.0},
+    {"ep_posterior", -100.0, -60.0, -90.0, -20.0, -70.0},
+    {"ep_lateral", -50.0, -20.0, -55.0, 0.0, -10.0},
+  };
+
+  std::vector< BenchmarkCase > cases;
+  for (const ProbeConfiguration& configuration : probes)
+  {
+    const std::string prefix = configuration.name + "/";
+    NeuroKinematics   NeuroKinematics_(&configuration.probe);
+
+    // A new instance shares the RCM point set of the previous ones
+    cases.push_back(Run(prefix + "WorkspaceVisualization", repetitions,
+                        [&](Eigen::Matrix3Xf& point_set) {
+                          WorkspaceVisualization workspace(NeuroKinematics_);
+                          point_set =
+                            workspace.GetRcmPointSetIndex().getPoints();
+                          return 1;
+                        }));
+    WorkspaceVisualization WorkspaceVisualization_(NeuroKinematics_);
+    cases.push_back(Run(prefix + "GetGeneralWorkspace", repetitions,
+                        [&](Eigen::Matrix3Xf& point_set) {
+                          point_set =
+                            WorkspaceVisualization_.GetGeneralWorkspace();
+                          return 1;
+                        }));
+    cases.push_back(Run(prefix + "GetEntryPointWorkspace", repetitions,
+                        [&](Eigen::Matrix3Xf& point_set) {
+                          point_set =
+                            WorkspaceVisualization_.GetEntryPointWorkspace();
+                          return 1;
+                        }));
+    cases.push_back(Run(prefix + "GetRcmWorkSpace", repetitions,
+                        [&](Eigen::Matrix3Xf& point_set) {
+                          point_set = WorkspaceVisualization_.GetRcmWorkSpace();
+                          return 1;
+                        }));
+    cases.push_back(Run(prefix + "GetRcmPointSet", repetitions,
+                        [&](Eigen::Matrix3Xf& point_set) {
+                          point_set = WorkspaceVisualization_.GetRcmPointSet();
+                          return 1;
+                        }));
+
+    for (const EntryPointConfiguration& entry_point : entry_points)
+    {
+      const Eigen::Vector4d ep_in_robot =
+        NeuroKinematics_
+          .ForwardKinematics_EntryPoint(
+            entry_point.axial_head, entry_point.axial_feet, entry_point.lateral,
+            0, 0, entry_point.pitch_degree * M_PI / 180,
+            entry_point.yaw_degree * M_PI / 180)
+          .zFrameToTreatment.col(3);
+      cases.push_back(Run(prefix + "GetSubWorkspace/" + entry_point.name,
+                          repetitions, [&](Eigen::Matrix3Xf& point_set) {
+                            return WorkspaceVisualization_.GetSubWorkspace(
+                              ep_in_robot.head< 3 >(), point_set);
+                          }));
+    }
+  }
+
+  int exit_status = 0;
+  std::map< std::string, PointSetSignature > golden;
+  std::map< std::string, std::string >       golden_results;
+  if (update_golden)
+  {
+    if (!WriteGoldenFile(golden_file, cases))
+    {
+      std::cerr << "Could not write " << golden_file << std::endl;
+      return 1;
+    }
+    std::cerr << "Updated " << golden_file << std::endl;
+  }
+  else if (!ReadGoldenFile(golden_file, golden))
+  {
+    std::cerr << "Could not read " << golden_file << std::endl;
+    exit_status = 1;
+  }
+  for (const BenchmarkCase& benchmark_case : cases)
+  {
+    std::string result = "updated";
+    if (!update_golden)
+    {
+      auto it = golden.find(benchmark_case.name);
+      if (it == golden.end())
+      {
+        result = "missing";
+      }
+      else if (MatchesSignature(benchmark_case.signature, it->second))
+      {
+        result = "match";
+      }
+      else
+      {
+        result = "mismatch";
+      }
+      if (result != "match")
+      {
+        std::cerr << benchmark_case.name << ": golden signature " << result
+                  << std::endl;
+        exit_status = 1;
+      }
+    }
+    golden_results[benchmark_case.name] = result;
+  }
+
+  std::ostringstream json;
+  json << std::setprecision(9) << "{\n"
+       << "  \"benchmark\": \"workspace\",\n"
+       << "  \"repetitions\": " << repetitions << ",\n"
+       << "  \"golden_file\": \"" << golden_file << "\",\n"
+       << "  \"results\": [\n";
+  for (size_t i = 0; i < cases.size(); i++)
+  {
+    const BenchmarkCase&     benchmark_case = cases[i];
+    const PointSetSignature& signature      = benchmark_case.signature;
+    json << "    {\"name\": \"" << benchmark_case.name << "\", "
+         << "\"seconds\": " << benchmark_case.seconds << ", "
+         << "\"peak_rss_kb\": " << benchmark_case.peak_rss_kb << ", "
+         << "\"status\": " << benchmark_case.status << ", "
+         << "\"points\": " << signature.count << ", "
+         << "\"points_per_second\": "
+         << signature.count / benchmark_case.seconds << ", "
+         << "\"golden\": \"" << golden_results[benchmark_case.name] << "\"}"
+         << ((i + 1 < cases.size()) ? ",\n" : "\n");
+  }
+  json << "  ]\n"
+       << "}\n";
+
+  if (!output_file.empty())
+  {
+    std::ofstream file(output_file);
+    if (!file)
+    {
+      std::cerr << "Could not open " << output_file << std::endl;
+      return 1;
+    }
+    file << json.str();
+  }
+  else
+  {
+    std::cout << json.str();
+  }
+  return exit_status;
+}
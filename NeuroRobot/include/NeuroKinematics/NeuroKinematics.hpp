@@ -17,23 +17,69 @@
 
 #include <eigen3/Eigen/Dense>
 
+// The kinematics are templated on the scalar type and explicitly instantiated
+// for float and double in NeuroKinematics.cpp. The double versions keep the
+// original names below, the float versions are suffixed with f.
+
 // TODO : Rename Prostate FK and IK structs following this convention
-struct Neuro_FK_outputs
+template < typename Scalar >
+struct Neuro_FK_outputsT
+{
+  Eigen::Matrix< Scalar, 4, 4 > zFrameToTreatment;
+};
+typedef Neuro_FK_outputsT< double > Neuro_FK_outputs;
+typedef Neuro_FK_outputsT< float >  Neuro_FK_outputsf;
+
+// Frames that can be requested from the fused forward kinematics. Values can
+// be combined with a bitwise or.
+enum Neuro_FK_frames
+{
+  NEURO_FK_RCM         = 1 << 0,
+  NEURO_FK_ENTRY_POINT = 1 << 1,
+  NEURO_FK_TREATMENT   = 1 << 2,
+  NEURO_FK_ALL_FRAMES =
+    NEURO_FK_RCM | NEURO_FK_ENTRY_POINT | NEURO_FK_TREATMENT
+};
+
+template < typename Scalar >
+struct Neuro_FK_frames_outputsT
+{
+  Eigen::Matrix< Scalar, 4, 4 > zFrameToRCM;
+  Eigen::Matrix< Scalar, 4, 4 > zFrameToEntryPoint;
+  Eigen::Matrix< Scalar, 4, 4 > zFrameToTreatment;
+};
+typedef Neuro_FK_frames_outputsT< double > Neuro_FK_frames_outputs;
+typedef Neuro_FK_frames_outputsT< float >  Neuro_FK_frames_outputsf;
+
+// Geometric Jacobians of the RCM, entry point and treatment frames w.r.t the
+// Z-frame. Rows are the linear and then the angular velocity, columns follow
+// the joint order of the FK arguments (AxialHead, AxialFeet, Lateral,
+// ProbeInsertion, ProbeRotation, Pitch, Yaw).
+template < typename Scalar >
+struct Neuro_Jacobian_outputsT
 {
-  Eigen::Matrix4d zFrameToTreatment;
+  Eigen::Matrix< Scalar, 6, 7 > zFrameToRCM;
+  Eigen::Matrix< Scalar, 6, 7 > zFrameToEntryPoint;
+  Eigen::Matrix< Scalar, 6, 7 > zFrameToTreatment;
 };
+typedef Neuro_Jacobian_outputsT< double > Neuro_Jacobian_outputs;
+typedef Neuro_Jacobian_outputsT< float >  Neuro_Jacobian_outputsf;
 
-struct Neuro_IK_outputs
+template < typename Scalar >
+struct Neuro_IK_outputsT
 {
-  Eigen::Matrix4d targetPose;
-  double          AxialFeetTranslation;
-  double          AxialHeadTranslation;
-  double          LateralTranslation;
-  double          ProbeInsertion;
-  double          ProbeRotation;
-  double          YawRotation;
-  double          PitchRotation;
+  Eigen::Matrix< Scalar, 4, 4 > targetPose;
+  Scalar                        AxialFeetTranslation;
+  Scalar                        AxialHeadTranslation;
+  Scalar                        LateralTranslation;
+  Scalar                        ProbeInsertion;
+  Scalar                        ProbeRotation;
+  Scalar                        YawRotation;
+  Scalar                        PitchRotation;
 };
+typedef Neuro_IK_outputsT< double > Neuro_IK_outputs;
+typedef Neuro_IK_outputsT< float >  Neuro_IK_outputsf;
+
 struct IK_Solver_outputs
 {
   double AxialFeetTranslation;
@@ -41,6 +87,95 @@ struct IK_Solver_outputs
   double LateralTranslation;
 };
 
+// Structure-of-arrays joint configurations used by the batched kinematics.
+// Every array holds one entry per configuration and all arrays must have the
+// same size.
+template < typename Scalar >
+struct Neuro_joint_batchT
+{
+  typedef Eigen::Array< Scalar, Eigen::Dynamic, 1 > ArrayX;
+
+  ArrayX AxialHeadTranslation;
+  ArrayX AxialFeetTranslation;
+  ArrayX LateralTranslation;
+  ArrayX ProbeInsertion;
+  ArrayX ProbeRotation;
+  ArrayX PitchRotation;
+  ArrayX YawRotation;
+
+  Eigen::Index size() const
+  {
+    return AxialHeadTranslation.size();
+  }
+
+  void resize(Eigen::Index n)
+  {
+    AxialHeadTranslation.resize(n);
+    AxialFeetTranslation.resize(n);
+    LateralTranslation.resize(n);
+    ProbeInsertion.resize(n);
+    ProbeRotation.resize(n);
+    PitchRotation.resize(n);
+    YawRotation.resize(n);
+  }
+};
+// Batches are mostly used for workspace sweeps, so the unsuffixed name is the
+// float version
+typedef Neuro_joint_batchT< float >  Neuro_joint_batch;
+typedef Neuro_joint_batchT< double > Neuro_joint_batchd;
+
+// Joint limits of the robot. The default values are the limits of the
+// hardware, all angles are in radians and all lengths in mm.
+struct Neuro_joint_limits
+{
+  double min_axial_separation;
+  double max_axial_separation;
+  double min_axial_head_translation;
+  double max_axial_head_translation;
+  double min_axial_feet_translation;
+  double max_axial_feet_translation;
+  double min_lateral_translation;
+  double max_lateral_translation;
+  double min_probe_insertion;
+  double max_probe_insertion;
+  double min_pitch_rotation;
+  double max_pitch_rotation;
+  double min_yaw_rotation;
+  double max_yaw_rotation;
+
+  Neuro_joint_limits()
+  {
+    min_axial_separation       = 75;
+    max_axial_separation       = 146;
+    min_axial_head_translation = -145;
+    max_axial_head_translation = 0;
+    min_axial_feet_translation = -77;
+    max_axial_feet_translation = 68;
+    min_lateral_translation    = -98;
+    max_lateral_translation    = -49;
+    min_probe_insertion        = 0;
+    max_probe_insertion        = 40;
+    min_pitch_rotation         = -37.0 * M_PI / 180;
+    max_pitch_rotation         = 26.0 * M_PI / 180;
+    min_yaw_rotation           = -88.0 * M_PI / 180;
+    max_yaw_rotation           = 0.0;
+  }
+};
+
+// Reasons for rejecting a joint configuration, one bit per violated limit.
+// NaN joint values, e.g. from an unreachable IK target, violate their limit.
+enum Neuro_joint_limit_violations
+{
+  NEURO_LIMIT_NONE             = 0,
+  NEURO_LIMIT_AXIAL_SEPARATION = 1 << 0,
+  NEURO_LIMIT_AXIAL_HEAD       = 1 << 1,
+  NEURO_LIMIT_AXIAL_FEET       = 1 << 2,
+  NEURO_LIMIT_LATERAL          = 1 << 3,
+  NEURO_LIMIT_PROBE_INSERTION  = 1 << 4,
+  NEURO_LIMIT_PITCH            = 1 << 5,
+  NEURO_LIMIT_YAW              = 1 << 6
+};
+
 struct Probe
 {
   double _cannulaToTreatment;
@@ -49,74 +184,159 @@ struct Probe
   double _robotToTreatmentAtHome;
 };
 
-class NeuroKinematics
+template < typename Scalar >
+class NeuroKinematicsT
 {
 
 public:
+  typedef Eigen::Matrix< Scalar, 3, 3 >              Matrix3;
+  typedef Eigen::Matrix< Scalar, 4, 4 >              Matrix4;
+  typedef Eigen::Matrix< Scalar, 3, 1 >              Vector3;
+  typedef Eigen::Matrix< Scalar, 4, 1 >              Vector4;
+  typedef Eigen::Matrix< Scalar, 3, Eigen::Dynamic > Matrix3X;
+  typedef Eigen::Array< Scalar, Eigen::Dynamic, 1 >  ArrayX;
+  typedef Eigen::Array< bool, Eigen::Dynamic, 1 >    ArrayXb;
+  typedef Eigen::Matrix< Scalar, 6, 7 >              Jacobian;
+  // Column i holds the column-major 6x7 Jacobian of configuration i, use
+  // Eigen::Map< Jacobian >(batch.col(i).data()) to access it
+  typedef Eigen::Matrix< Scalar, 42, Eigen::Dynamic > JacobianBatch;
+
   //================ Constructor ================
-  NeuroKinematics();
-  NeuroKinematics(Probe* probe);  /// This value comes from the robot probe
+  NeuroKinematicsT();
+  NeuroKinematicsT(
+    const Probe* probe);  /// This value comes from the robot probe
   // NeuroKinematics(Probe probe); /// This value comes from the robot probe
 
+  // Converts the robot parameters of a kinematics object of another scalar
+  // type, e.g. to run a float workspace sweep next to the double kinematics
+  template < typename OtherScalar >
+  explicit NeuroKinematicsT(const NeuroKinematicsT< OtherScalar >& other);
+
   //================ Parameters =================
   // Robot Specific Parameters
-  double _lengthOfAxialTrapezoidSideLink;
-  double _initialAxialSeperation;
-  double _widthTrapezoidTop;
-  double _xInitialRCM;
-  double _yInitialRCM;
-  double _zInitialRCM;
-  double _robotToRCMOffset;
-
-  Probe*          _probe;  // Object that stores probe specific configurations
-  Eigen::Matrix4d _zFrameToRCM;  // Transformation that accounts for change in
-                                 // rotation between zFrame and RCM
-
-  // Parameters used in IK and FK calculations are moved out of their functions
-  // to keep these methods running fast by eliminating the need to re-allocate
-  // memory every time
-  Eigen::Matrix3d xRotationDueToYawRotationFK;
-  Eigen::Matrix3d yRotationDueToPitchRotationFK;
-  Eigen::Matrix3d zRotationDueToProbeRotationFK;
-  Eigen::Matrix4d zFrameToRCMRotation;
-  Eigen::Matrix4d zFrameToRCMPrime;
-  Eigen::Matrix4d RCMToTreatment;
-  Eigen::Matrix4d RCMToEntryPoint;
-
-  Eigen::Matrix3d xRotationDueToYawRotationIK;
-  Eigen::Matrix3d yRotationDueToPitchRotationIK;
-  Eigen::Matrix3d zRotationDueToProbeRotationIK;
-  Eigen::Matrix4d zFrameToTargetPointFinal;
+  Scalar _lengthOfAxialTrapezoidSideLink;
+  Scalar _initialAxialSeperation;
+  Scalar _widthTrapezoidTop;
+  Scalar _xInitialRCM;
+  Scalar _yInitialRCM;
+  Scalar _zInitialRCM;
+  Scalar _robotToRCMOffset;
+
+  // Object that stores probe specific configurations
+  const Probe* _probe;
+  Matrix4      _zFrameToRCM;  // Transformation that accounts for change in
+                              // rotation between zFrame and RCM
+
+  // Terms that only depend on the robot parameters. They are computed by the
+  // constructors and have to be refreshed with UpdateRobotInvariants() if any
+  // of the parameters above is changed.
+  Scalar  _yTrapezoidHypotenuseSquared;  // L1 squared
+  Scalar  _yTrapezoidInitialHeight;      // Trapezoid height at delta_Zh
+  Matrix4 _zFrameToRCMInverse;
+
+  // All kinematics methods are const and only use stack-local temporaries, so
+  // a single instance can be shared by several threads as long as the robot
+  // parameters and the probe are not modified while they run.
 
   //================ Public Methods ==============
+  // Method to recompute the robot invariants after a parameter change
+  void UpdateRobotInvariants();
+
   // Method to calculate the location of the treatment w.r.t Z-frame
-  Neuro_FK_outputs ForwardKinematics(double AxialHeadTranslation,
-                                     double AxialFeetTranslation,
-                                     double LateralTranslation,
-                                     double ProbeInsertion,
-                                     double ProbeRotation, double PitchRotation,
-                                     double YawRotation);
+  Neuro_FK_outputsT< Scalar > ForwardKinematics(
+    Scalar AxialHeadTranslation, Scalar AxialFeetTranslation,
+    Scalar LateralTranslation, Scalar ProbeInsertion, Scalar ProbeRotation,
+    Scalar PitchRotation, Scalar YawRotation) const;
 
   // Forward kinematic that returns entry point location instead of treatment
-  Neuro_FK_outputs ForwardKinematics_EntryPoint(
-    double AxialHeadTranslation, double AxialFeetTranslation,
-    double LateralTranslation, double ProbeInsertion, double ProbeRotation,
-    double PitchRotation, double YawRotation);
+  Neuro_FK_outputsT< Scalar > ForwardKinematics_EntryPoint(
+    Scalar AxialHeadTranslation, Scalar AxialFeetTranslation,
+    Scalar LateralTranslation, Scalar ProbeInsertion, Scalar ProbeRotation,
+    Scalar PitchRotation, Scalar YawRotation) const;
 
   // Method for the calculation of the location of the RCM w.r.t Z-frame
-  Neuro_FK_outputs GetRcm(double AxialHeadTranslation,
-                          double AxialFeetTranslation,
-                          double LateralTranslation, double ProbeInsertion,
-                          double ProbeRotation, double PitchRotation,
-                          double YawRotation);
+  Neuro_FK_outputsT< Scalar > GetRcm(Scalar AxialHeadTranslation,
+                                     Scalar AxialFeetTranslation,
+                                     Scalar LateralTranslation,
+                                     Scalar ProbeInsertion,
+                                     Scalar ProbeRotation, Scalar PitchRotation,
+                                     Scalar YawRotation) const;
+  // Method that computes the RCM frame once and returns any combination of
+  // the RCM, entry point and treatment frames (see Neuro_FK_frames)
+  Neuro_FK_frames_outputsT< Scalar > ForwardKinematicsFrames(
+    Scalar AxialHeadTranslation, Scalar AxialFeetTranslation,
+    Scalar LateralTranslation, Scalar ProbeInsertion, Scalar ProbeRotation,
+    Scalar PitchRotation, Scalar YawRotation,
+    int frames = NEURO_FK_ALL_FRAMES) const;
+
+  // Batched version of ForwardKinematics which only keeps the translation
+  // column. Column i of treatment_positions receives the treatment location of
+  // configuration i. The matrix is resized only if it does not already hold
+  // joints.size() columns.
+  void ForwardKinematicsBatch(const Neuro_joint_batchT< Scalar >& joints,
+                              Matrix3X& treatment_positions) const;
+
+  // Batched version of ForwardKinematicsFrames. Positions are written for
+  // every non-NULL output, so passing NULL skips that frame.
+  void ForwardKinematicsFramesBatch(const Neuro_joint_batchT< Scalar >& joints,
+                                    Matrix3X* rcm_positions,
+                                    Matrix3X* entry_point_positions,
+                                    Matrix3X* treatment_positions) const;
+
+  // Method to calculate the Jacobians of any combination of the RCM, entry
+  // point and treatment frames (see Neuro_FK_frames). They are evaluated in
+  // closed form at about the cost of one FK call. Jacobians that are not
+  // requested are left as zero.
+  Neuro_Jacobian_outputsT< Scalar > Jacobians(
+    Scalar AxialHeadTranslation, Scalar AxialFeetTranslation,
+    Scalar LateralTranslation, Scalar ProbeInsertion, Scalar ProbeRotation,
+    Scalar PitchRotation, Scalar YawRotation,
+    int frames = NEURO_FK_ALL_FRAMES) const;
+
+  // Batched version of Jacobians. Jacobians are written for every non-NULL
+  // output, so passing NULL skips that frame.
+  void JacobiansBatch(const Neuro_joint_batchT< Scalar >& joints,
+                      JacobianBatch*                      rcm_jacobians,
+                      JacobianBatch* entry_point_jacobians,
+                      JacobianBatch* treatment_jacobians) const;
+
   // Method to calculate joint values given a desired EP and TP
-  Neuro_IK_outputs InverseKinematics(Eigen::Vector4d entryPointzFrame,
-                                     Eigen::Vector4d targetPointzFrame);
+  Neuro_IK_outputsT< Scalar > InverseKinematics(
+    Vector4 entryPointzFrame, Vector4 targetPointzFrame) const;
+
+  // Batched version of InverseKinematics for a single entry point and many
+  // target points. Column i of targetPointszFrame is a target point w.r.t the
+  // Z-frame and entry i of joints receives its joint values. The terms that
+  // only depend on the entry point are evaluated once for the whole batch.
+  void InverseKinematicsBatch(const Vector4&                entryPointzFrame,
+                              const Matrix3X&               targetPointszFrame,
+                              Neuro_joint_batchT< Scalar >& joints) const;
+
+  // Method to check a batch of joint configurations, e.g. IK solutions,
+  // against the joint limits. Entry i of accepted is true if configuration i
+  // is within every limit. If violations is not NULL, entry i receives the
+  // Neuro_joint_limit_violations bits of configuration i. The check is branch
+  // free so it vectorizes over the batch.
+  void CheckJointLimits(const Neuro_joint_batchT< Scalar >& joints,
+                        const Neuro_joint_limits& limits, ArrayXb& accepted,
+                        Eigen::ArrayXi* violations = NULL) const;
 
   // IK Method for calculation of the cartesian base based on a given Entry
   // point and an RCM point as the target point
-  Neuro_IK_outputs InverseKinematicsWithZeroProbeInsertion(
-    Eigen::Vector4d entry_point, Eigen::Vector4d target_point);
+  Neuro_IK_outputsT< Scalar > InverseKinematicsWithZeroProbeInsertion(
+    Vector4 entry_point, Vector4 target_point) const;
+
+private:
+  // Pose of the RCM w.r.t the Z-frame, shared by every FK method
+  Matrix4 GetZFrameToRCM(Scalar AxialHeadTranslation,
+                         Scalar AxialFeetTranslation, Scalar LateralTranslation,
+                         Scalar ProbeRotation, Scalar PitchRotation,
+                         Scalar YawRotation) const;
 };
 
+// Clinical IK and the final trajectory use double precision, visualization
+// grade workspace sweeps can use the float version at twice the SIMD width
+typedef NeuroKinematicsT< double > NeuroKinematics;
+typedef NeuroKinematicsT< float >  NeuroKinematicsf;
+
 #endif /* NEUROKINEMATICS_HPP_ */
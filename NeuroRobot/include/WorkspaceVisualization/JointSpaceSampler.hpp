@@ -0,0 +1,115 @@
+#pragma once
+#include "NeuroKinematics/NeuroKinematics.hpp"
+#include <cmath>
+#include <vector>
+
+// Joint values of one configuration of the robot
+struct JointConfiguration
+{
+  double AxialHeadTranslation;
+  double AxialFeetTranslation;
+  double LateralTranslation;
+  double ProbeInsertion;
+  double ProbeRotation;
+  double PitchRotation;
+  double YawRotation;
+};
+
+/* Samples the joint space of the robot from a list of patches and evaluates
+the FK of every sample. A patch starts from a base configuration and sweeps
+up to a few axes as nested loops, the first axis being the outermost one. An
+axis moves every joint it has a non-zero step for, so coupled joints (e.g. the
+axial head and feet moving together) share one axis. Joint values are
+accumulated one step at a time like the for loops the patches describe.*/
+class JointSpaceSampler
+{
+public:
+  struct Axis
+  {
+    JointConfiguration step;
+    int                count;
+  };
+
+  struct Patch
+  {
+    JointConfiguration  base;
+    std::vector< Axis > axes;
+    // Joint values along each axis, indexed like the samples of the axis
+    std::vector< std::vector< JointConfiguration > > values;
+    long                                             no_of_samples;
+  };
+
+  // Adds a patch and returns its number of samples
+  long AddPatch(const JointConfiguration&  base,
+                const std::vector< Axis >& axes = std::vector< Axis >());
+  void Clear();
+
+  // Total number of samples of all patches, known before any FK is evaluated
+  long GetNumberOfSamples() const;
+  const std::vector< Patch >& GetPatches() const;
+
+  // Joint configurations of the samples [begin, end) in patch order
+  void GetSamples(long begin, long end, JointConfiguration* samples) const;
+
+  // Position of the given frame for every sample, in sample order. The samples
+  // are split into chunks evaluated in parallel, each of them as one batch of
+  // the float kinematics.
+  Eigen::Matrix3Xf Evaluate(const NeuroKinematics& kinematics,
+                            Neuro_FK_frames        frame) const;
+
+  // Position of the given frame for a subset of the samples which follows the
+  // curvature of the surface. Every patch starts from a lattice of every
+  // coarse_stride-th sample along each axis. A cell is split in two along
+  // every axis while the midpoint of its samples along an axis lies further
+  // than tolerance (mm) from the middle of its two neighbours, or two
+  // neighbouring samples are further than max_spacing (mm) apart, 0 for no
+  // limit. Cells of one step are not split, so the finest samples are those of
+  // Evaluate.
+  Eigen::Matrix3Xf EvaluateAdaptive(const NeuroKinematics& kinematics,
+                                    Neuro_FK_frames frame, double tolerance,
+                                    double max_spacing,
+                                    int    coarse_stride = 8) const;
+
+  // Number of iterations of: for (v = start; condition(v); v += step)
+  template < typename Condition >
+  static int GetStepCount(double start, double step, Condition condition)
+  {
+    int count = 0;
+    for (double v = start; condition(v); v += step)
+    {
+      count++;
+      if (step == 0)
+      {
+        break;
+      }
+    }
+    return count;
+  }
+
+  // Number of iterations of: for (v = start; v <= stop; v += step), or
+  // v >= stop for negative steps
+  static int GetStepCount(double start, double step, double stop)
+  {
+    if (step < 0)
+    {
+      return GetStepCount(start, step, [stop](double v) { return v >= stop; });
+    }
+    return GetStepCount(start, step, [stop](double v) { return v <= stop; });
+  }
+
+  // Value after accumulating n steps from start
+  static double GetStepValue(double start, double step, int n)
+  {
+    for (int i = 0; i < n; i++)
+    {
+      start += step;
+    }
+    return start;
+  }
+
+private:
+  std::vector< Patch > Patches;
+  // Index of the first sample of each patch
+  std::vector< long > PatchOffsets;
+  long                NumberOfSamples = 0;
+};
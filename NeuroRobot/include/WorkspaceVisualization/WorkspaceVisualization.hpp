@@ -1,14 +1,36 @@
 #pragma once
 #include "NeuroKinematics/NeuroKinematics.hpp"
+#include "PointGridIndex/PointGridIndex.hpp"
+#include "WorkspaceVisualization/JointSpaceSampler.hpp"
+#include <limits>
+#include <memory>
+#include <vector>
+
+// Number of steps each joint range is split into by the workspace generators
+struct WorkspaceResolution
+{
+  double axial                   = 65.;  // Top and bottom of the workspaces
+  double lateral                 = 15.;  // Lateral sweeps, head and feet faces
+  double pitch                   = 10.;
+  double yaw                     = 15.;
+  double probe_insertion         = 10.;
+  double general_workspace_sides = 5.;
+  double rcm_point_set           = 30.;
+  // Distance (mm) the general and entry point workspace surfaces may deviate
+  // from the uniform samples, see JointSpaceSampler::EvaluateAdaptive, 0
+  // samples them uniformly
+  double surface_tolerance       = 0.;
+};
 
 class WorkspaceVisualization
 {
 
 public:
-  WorkspaceVisualization(NeuroKinematics& NeuroKinematics);
+  WorkspaceVisualization(
+    const NeuroKinematics&     NeuroKinematics,
+    const WorkspaceResolution& resolution = WorkspaceResolution());
 
   // members
-  double i, j, k, l, ii;  // counter initialization
   // Min allowed seperation 75mm
   // Max allowed seperation  146mm
   // Max allowed movement while one block is stationary 146-75 = 71 mm
@@ -43,24 +65,12 @@ public:
   const double Lateral_translation_end;
   const double Probe_insert_max;
   const double Probe_insert_min;
-  const double axial_resolution_;
-  const double Lateral_resolution;
-  const double desired_resolution;
-  const double pitch_resolution_;
-  const double yaw_resolution;
-  const double probe_insertion_resolution;
-  const double desired_resolution_general_ws;
-  int          counter;
-  // Robot axis
-  double           AxialHeadTranslation;
-  double           AxialFeetTranslation;
-  double           LateralTranslation;
-  double           PitchRotation;
-  double           YawRotation;
-  double           ProbeInsertion;
-  double           ProbeRotation;
-  NeuroKinematics  NeuroKinematics_;
-  Eigen::Matrix3Xf rcm_point_set_;
+  WorkspaceResolution resolution_;
+  NeuroKinematics    NeuroKinematics_;
+  NeuroKinematicsf   NeuroKinematicsf_;  // Single precision copy for batches
+  Neuro_joint_limits ik_joint_limits_;   // Limits for the sub-workspace IK
+  // RCM point set of the sub-workspaces, see GetRcmPointSetIndex
+  std::shared_ptr< const PointGridIndex > rcm_point_set_;
 
   enum WS_ERRORS_ENUM
   {
@@ -70,6 +80,26 @@ public:
 
   // methods
 
+  // Changes the resolution of the generators and drops the RCM point set
+  void SetResolution(const WorkspaceResolution& resolution);
+  const WorkspaceResolution& GetResolution() const;
+  // Resolution with factor times fewer steps along the joints of the general
+  // and entry point workspaces, at least one, for quick previews
+  static WorkspaceResolution
+    GetCoarseResolution(const WorkspaceResolution& resolution, double factor);
+
+  // Hash of the robot geometry and the joint ranges
+  uint64_t GetRobotParameterHash() const;
+  // Hash of everything the generated point sets depend on: the probe, the
+  // robot geometry, the joint ranges and the resolution. Used as the key of
+  // the on-disk workspace cache.
+  uint64_t GetParameterHash() const;
+
+  // Grid index over the RCM point set of GetRcmPointSet, built on first use.
+  // It does not depend on the probe, so it is shared by all the instances of
+  // the process with the same robot and resolution.
+  const PointGridIndex& GetRcmPointSetIndex();
+
   // Method to generate Point cloud of the surface of general reachable
   // Workspace
   Eigen::Matrix3Xf GetGeneralWorkspace();
@@ -78,6 +108,17 @@ public:
   // worskpace
   Eigen::Matrix3Xf GetEntryPointWorkspace();
 
+  // Patches of the surface of the general workspace. The entry point
+  // workspace visits the same configurations without the probe insertion
+  // sweeps, the entry point does not depend on the insertion.
+  void AddWorkspaceSurfacePatches(JointSpaceSampler& sampler,
+                                  bool               sweep_probe_insertion);
+
+  // Patches of the RCM workspace, the sides are split into the given number
+  // of levels and lateral steps
+  void AddRcmPatches(JointSpaceSampler& sampler, double sides_resolution,
+                     double sides_lateral_step);
+
   // Method to generate Point cloud of the surface of the RCM Workspace
   Eigen::Matrix3Xf GetRcmWorkSpace();
 
@@ -105,13 +146,6 @@ public:
     Eigen::Vector3d  ep_in_robot_coordinate,
     Eigen::VectorXd& treatment_to_tp_dist);
 
-  /* Method which takes a 4X4 transformation matrix and extracts the position
-  vector and saves it inside an Eigen matrix*/
-  void StorePointToEigenMatrix(Eigen::Matrix3Xf& point_set,
-                               Eigen::Matrix4d   transformation_matrix);
-  void StorePointToEigenMatrix(Eigen::Matrix3Xf& point_set, double x, double y,
-                               double z);
-
   void CalculateTransform(Eigen::Matrix4d  registration_inv,
                           Eigen::Vector3d  ep_in_imager_coordinate,
                           Eigen::Vector3d& ep_in_robot_coordinate);
@@ -7,7 +7,8 @@
 
 #include "NeuroKinematics/NeuroKinematics.hpp"
 
-NeuroKinematics::NeuroKinematics()
+template < typename Scalar >
+NeuroKinematicsT< Scalar >::NeuroKinematicsT()
 {
   _lengthOfAxialTrapezoidSideLink = 0;
   _widthTrapezoidTop              = 0;
@@ -21,23 +22,14 @@ NeuroKinematics::NeuroKinematics()
   _probe = NULL;
 
   // Transformation that accounts for change in rotation between zFrame and RCM
-  _zFrameToRCM = Eigen::Matrix4d::Identity();
-
-  // Optimizations
-  xRotationDueToYawRotationFK   = Eigen::Matrix3d::Identity();
-  yRotationDueToPitchRotationFK = Eigen::Matrix3d::Identity();
-  zRotationDueToProbeRotationFK = Eigen::Matrix3d::Identity();
-  zFrameToRCMRotation           = Eigen::Matrix4d::Identity();
-  zFrameToRCMPrime              = Eigen::Matrix4d::Identity();
-  RCMToTreatment                = Eigen::Matrix4d::Identity();
-  xRotationDueToYawRotationIK   = Eigen::Matrix3d::Identity();
-  RCMToEntryPoint               = Eigen::Matrix4d::Identity();
-  yRotationDueToPitchRotationIK = Eigen::Matrix3d::Identity();
-  zRotationDueToProbeRotationIK = Eigen::Matrix3d::Identity();
-  zFrameToTargetPointFinal      = Eigen::Matrix4d::Identity();
+  _zFrameToRCM = Matrix4::Identity();
+
+  UpdateRobotInvariants();
 }
 
-NeuroKinematics::NeuroKinematics(Probe* probe) : _probe(probe)
+template < typename Scalar >
+NeuroKinematicsT< Scalar >::NeuroKinematicsT(const Probe* probe)
+  : _probe(probe)
 {
   // All values are in units of mm
   _lengthOfAxialTrapezoidSideLink = 60;   // L1 link
@@ -51,25 +43,38 @@ NeuroKinematics::NeuroKinematics(Probe* probe) : _probe(probe)
   // Transformation that accounts for change in rotation between zFrame and RCM
   _zFrameToRCM << -1, 0, 0, 0, 0, 0, -1, 0, 0, -1, 0, 0, 0, 0, 0, 1;
 
-  // Optimizations
-  // These are the values for the RCM shown in the paper
-  xRotationDueToYawRotationFK   = Eigen::Matrix3d::Identity();
-  yRotationDueToPitchRotationFK = Eigen::Matrix3d::Identity();
-  zRotationDueToProbeRotationFK = Eigen::Matrix3d::Identity();
-  // Rotation from the fixed z-frame to the RCM point
-  zFrameToRCMRotation = Eigen::Matrix4d::Identity();
-  // What is the RCM prime?
-  zFrameToRCMPrime = Eigen::Matrix4d::Identity();
-  // RCM to the tooltip (probe's tip)
-  RCMToTreatment = Eigen::Matrix4d::Identity();
-  // RCM to the Entry point (probe's tip)
-  RCMToEntryPoint = Eigen::Matrix4d::Identity();
-
-  // IK related attributes
-  xRotationDueToYawRotationIK   = Eigen::Matrix3d::Identity();
-  yRotationDueToPitchRotationIK = Eigen::Matrix3d::Identity();
-  zRotationDueToProbeRotationIK = Eigen::Matrix3d::Identity();
-  zFrameToTargetPointFinal      = Eigen::Matrix4d::Identity();
+  UpdateRobotInvariants();
+}
+
+template < typename Scalar >
+template < typename OtherScalar >
+NeuroKinematicsT< Scalar >::NeuroKinematicsT(
+  const NeuroKinematicsT< OtherScalar >& other)
+  : _probe(other._probe)
+{
+  _lengthOfAxialTrapezoidSideLink = other._lengthOfAxialTrapezoidSideLink;
+  _widthTrapezoidTop              = other._widthTrapezoidTop;
+  _initialAxialSeperation         = other._initialAxialSeperation;
+  _xInitialRCM                    = other._xInitialRCM;
+  _yInitialRCM                    = other._yInitialRCM;
+  _zInitialRCM                    = other._zInitialRCM;
+  _robotToRCMOffset               = other._robotToRCMOffset;
+  _zFrameToRCM = other._zFrameToRCM.template cast< Scalar >();
+
+  // Computed in the target precision rather than converted
+  UpdateRobotInvariants();
+}
+
+// Method to precompute the terms of the kinematics that only depend on the
+// robot parameters
+template < typename Scalar >
+void NeuroKinematicsT< Scalar >::UpdateRobotInvariants()
+{
+  _yTrapezoidHypotenuseSquared = pow(_lengthOfAxialTrapezoidSideLink, 2);
+  _yTrapezoidInitialHeight =
+    sqrt(_yTrapezoidHypotenuseSquared -
+         pow((_initialAxialSeperation - _widthTrapezoidTop) / 2, 2));
+  _zFrameToRCMInverse = _zFrameToRCM.inverse();
 }
 
 // This method defines the forward kinematics for the neurosurgery robot.
@@ -85,58 +90,22 @@ NeuroKinematics::NeuroKinematics(Probe* probe) : _probe(probe)
    needle or the probe to pass through the burr hole 6) ProbeRotation (Rz
    continuous deg) 7) ProbeInsertion (PI ranging from -40 to 0 mm)
    */
-Neuro_FK_outputs NeuroKinematics::ForwardKinematics(
-  double AxialHeadTranslation, double AxialFeetTranslation,
-  double LateralTranslation, double ProbeInsertion, double ProbeRotation,
-  double PitchRotation, double YawRotation)
+template < typename Scalar >
+Neuro_FK_outputsT< Scalar > NeuroKinematicsT< Scalar >::ForwardKinematics(
+  Scalar AxialHeadTranslation, Scalar AxialFeetTranslation,
+  Scalar LateralTranslation, Scalar ProbeInsertion, Scalar ProbeRotation,
+  Scalar PitchRotation, Scalar YawRotation) const
 {
   // Structure to return with the FK output( struct can be remove )
-  struct Neuro_FK_outputs FK;
-
-  // Z position of RCM is solely defined as the midpoint of the axial trapezoid
-  double axialTrapezoidMidpoint =
-    (AxialHeadTranslation - AxialFeetTranslation + _initialAxialSeperation) /
-    2;  // initial position
-  double zDeltaRCM = (AxialFeetTranslation + AxialHeadTranslation) / 2;
-
-  // Y position of RCM is found by pythagorean theorem of the axial trapezoid
-  double yTrapezoidHypotenuseSquared = pow(_lengthOfAxialTrapezoidSideLink, 2);
-  double yTrapezoidSideSquared =
-    pow((axialTrapezoidMidpoint - _widthTrapezoidTop / 2), 2);
-  double yTrapezoidInitialSeparationSquared =
-    pow((_initialAxialSeperation - _widthTrapezoidTop) / 2, 2);
-  double yDeltaRCM =
-    sqrt(yTrapezoidHypotenuseSquared - yTrapezoidSideSquared) -
-    sqrt(yTrapezoidHypotenuseSquared - yTrapezoidInitialSeparationSquared);
-
-  // X position of RCM is solely defined as the amount traveled in lateral
-  // translation
-  double xDeltaRCM = LateralTranslation;
-
-  // Obtain basic Yaw, Pitch, and Roll Rotations
-  xRotationDueToYawRotationFK << 1, 0, 0, 0, cos(YawRotation),
-    -sin(YawRotation), 0, sin(YawRotation), cos(YawRotation);
-
-  yRotationDueToPitchRotationFK << cos(PitchRotation), 0, sin(PitchRotation), 0,
-    1, 0, -sin(PitchRotation), 0, cos(PitchRotation);
-
-  zRotationDueToProbeRotationFK << cos(ProbeRotation), -sin(ProbeRotation), 0,
-    sin(ProbeRotation), cos(ProbeRotation), 0, 0, 0, 1;
-
-  // Calculate the XYZ Rotation
-  zFrameToRCMRotation.block(0, 0, 3, 3) =
-    (xRotationDueToYawRotationFK * yRotationDueToPitchRotationFK *
-     zRotationDueToProbeRotationFK)
-      .block(0, 0, 3, 3);
-
-  // Calculate the XYZ Translation
-  zFrameToRCMPrime << -1, 0, 0, _xInitialRCM + xDeltaRCM, 0, 0, -1,
-    _yInitialRCM + yDeltaRCM, 0, -1, 0, _zInitialRCM + zDeltaRCM, 0, 0, 0, 1;
+  Neuro_FK_outputsT< Scalar > FK;
 
-  // Now Calculate zFrame to RCM given the calculated values above
-  Eigen::Matrix4d zFrameToRCM = zFrameToRCMPrime * zFrameToRCMRotation;
+  Matrix4 zFrameToRCM =
+    GetZFrameToRCM(AxialHeadTranslation, AxialFeetTranslation,
+                   LateralTranslation, ProbeRotation, PitchRotation,
+                   YawRotation);
 
   // Create RCM to Treatment Matrix
+  Matrix4 RCMToTreatment = Matrix4::Identity();
   RCMToTreatment(2, 3) =
     ProbeInsertion + _probe->_robotToTreatmentAtHome - _robotToRCMOffset;
 
@@ -146,81 +115,371 @@ Neuro_FK_outputs NeuroKinematics::ForwardKinematics(
 
   return FK;
 }
-Neuro_FK_outputs NeuroKinematics::ForwardKinematics_EntryPoint(
-  double AxialHeadTranslation, double AxialFeetTranslation,
-  double LateralTranslation, double ProbeInsertion, double ProbeRotation,
-  double PitchRotation, double YawRotation)
+
+template < typename Scalar >
+Neuro_FK_outputsT< Scalar >
+NeuroKinematicsT< Scalar >::ForwardKinematics_EntryPoint(
+  Scalar AxialHeadTranslation, Scalar AxialFeetTranslation,
+  Scalar LateralTranslation, Scalar ProbeInsertion, Scalar ProbeRotation,
+  Scalar PitchRotation, Scalar YawRotation) const
 {
   // Structure to return with the FK output( struct can be remove )
-  struct Neuro_FK_outputs FK;
+  Neuro_FK_outputsT< Scalar > FK;
 
-  // Z position of RCM is solely defined as the midpoint of the axial trapezoid
-  double axialTrapezoidMidpoint =
-    (AxialHeadTranslation - AxialFeetTranslation + _initialAxialSeperation) /
-    2;  // initial position
-  double zDeltaRCM = (AxialFeetTranslation + AxialHeadTranslation) / 2;
+  Matrix4 zFrameToRCM =
+    GetZFrameToRCM(AxialHeadTranslation, AxialFeetTranslation,
+                   LateralTranslation, ProbeRotation, PitchRotation,
+                   YawRotation);
 
-  // Y position of RCM is found by pythagorean theorem of the axial trapezoid
-  double yTrapezoidHypotenuseSquared = pow(_lengthOfAxialTrapezoidSideLink, 2);
-  double yTrapezoidSideSquared =
-    pow((axialTrapezoidMidpoint - _widthTrapezoidTop / 2), 2);
-  double yTrapezoidInitialSeparationSquared =
-    pow((_initialAxialSeperation - _widthTrapezoidTop) / 2, 2);
-  double yDeltaRCM =
-    sqrt(yTrapezoidHypotenuseSquared - yTrapezoidSideSquared) -
-    sqrt(yTrapezoidHypotenuseSquared - yTrapezoidInitialSeparationSquared);
+  // Create RCM to Entry Point Matrix
+  Matrix4 RCMToEntryPoint = Matrix4::Identity();
+  RCMToEntryPoint(2, 3) = _probe->_robotToEntry - _robotToRCMOffset;
 
-  // X position of RCM is solely defined as the amount traveled in lateral
-  // translation
-  double xDeltaRCM = LateralTranslation;
+  // Finally calculate Base to Entry Point using the measured transformation
+  // for RCM to Entry Point
+  FK.zFrameToTreatment = zFrameToRCM * RCMToEntryPoint;
 
-  // Obtain basic Yaw, Pitch, and Roll Rotations
-  xRotationDueToYawRotationFK << 1, 0, 0, 0, cos(YawRotation),
-    -sin(YawRotation), 0, sin(YawRotation), cos(YawRotation);
+  return FK;
+}
 
-  yRotationDueToPitchRotationFK << cos(PitchRotation), 0, sin(PitchRotation), 0,
-    1, 0, -sin(PitchRotation), 0, cos(PitchRotation);
+// Method to calculate the RCM location w.r.t Z-frame
+template < typename Scalar >
+Neuro_FK_outputsT< Scalar > NeuroKinematicsT< Scalar >::GetRcm(
+  Scalar AxialHeadTranslation, Scalar AxialFeetTranslation,
+  Scalar LateralTranslation, Scalar ProbeInsertion, Scalar ProbeRotation,
+  Scalar PitchRotation, Scalar YawRotation) const
+{
+  // Structure to return with the FK output( struct can be remove )
+  Neuro_FK_outputsT< Scalar > RCM;
 
-  zRotationDueToProbeRotationFK << cos(ProbeRotation), -sin(ProbeRotation), 0,
-    sin(ProbeRotation), cos(ProbeRotation), 0, 0, 0, 1;
+  RCM.zFrameToTreatment =
+    GetZFrameToRCM(AxialHeadTranslation, AxialFeetTranslation,
+                   LateralTranslation, ProbeRotation, PitchRotation,
+                   YawRotation);
+  return RCM;
+}
 
-  // Calculate the XYZ Rotation
-  zFrameToRCMRotation.block(0, 0, 3, 3) =
-    (xRotationDueToYawRotationFK * yRotationDueToPitchRotationFK *
-     zRotationDueToProbeRotationFK)
-      .block(0, 0, 3, 3);
+// Fused forward kinematics. The RCM frame is computed once and the entry
+// point and treatment frames are obtained from it by their offsets along the
+// probe axis. Frames that are not requested are left as identity.
+template < typename Scalar >
+Neuro_FK_frames_outputsT< Scalar >
+NeuroKinematicsT< Scalar >::ForwardKinematicsFrames(
+  Scalar AxialHeadTranslation, Scalar AxialFeetTranslation,
+  Scalar LateralTranslation, Scalar ProbeInsertion, Scalar ProbeRotation,
+  Scalar PitchRotation, Scalar YawRotation, int frames) const
+{
+  Neuro_FK_frames_outputsT< Scalar > FK;
+  FK.zFrameToRCM        = Matrix4::Identity();
+  FK.zFrameToEntryPoint = Matrix4::Identity();
+  FK.zFrameToTreatment  = Matrix4::Identity();
+
+  Matrix4 zFrameToRCM =
+    GetZFrameToRCM(AxialHeadTranslation, AxialFeetTranslation,
+                   LateralTranslation, ProbeRotation, PitchRotation,
+                   YawRotation);
+
+  if (frames & NEURO_FK_RCM)
+  {
+    FK.zFrameToRCM = zFrameToRCM;
+  }
+  if (frames & NEURO_FK_ENTRY_POINT)
+  {
+    Matrix4 RCMToEntryPoint = Matrix4::Identity();
+    RCMToEntryPoint(2, 3) = _probe->_robotToEntry - _robotToRCMOffset;
+    FK.zFrameToEntryPoint = zFrameToRCM * RCMToEntryPoint;
+  }
+  if (frames & NEURO_FK_TREATMENT)
+  {
+    Matrix4 RCMToTreatment = Matrix4::Identity();
+    RCMToTreatment(2, 3) =
+      ProbeInsertion + _probe->_robotToTreatmentAtHome - _robotToRCMOffset;
+    FK.zFrameToTreatment = zFrameToRCM * RCMToTreatment;
+  }
 
-  // Calculate the XYZ Translation
-  zFrameToRCMPrime << -1, 0, 0, _xInitialRCM + xDeltaRCM, 0, 0, -1,
-    _yInitialRCM + yDeltaRCM, 0, -1, 0, _zInitialRCM + zDeltaRCM, 0, 0, 0, 1;
+  return FK;
+}
 
-  // Now Calculate zFrame to RCM given the calculated values above
-  Eigen::Matrix4d zFrameToRCM = zFrameToRCMPrime * zFrameToRCMRotation;
+template < typename Scalar >
+void NeuroKinematicsT< Scalar >::ForwardKinematicsBatch(
+  const Neuro_joint_batchT< Scalar >& joints,
+  Matrix3X&                           treatment_positions) const
+{
+  ForwardKinematicsFramesBatch(joints, NULL, NULL, &treatment_positions);
+}
 
-  // Create RCM to Treatment Matrix
-  RCMToEntryPoint(2, 3) = _probe->_robotToEntry - _robotToRCMOffset;
+// Batched forward kinematics for workspace sweeps.
+// Expanding zFrameToRCMPrime * zFrameToRCMRotation and keeping only the
+// translation column gives the RCM location
+//   x = xInitialRCM + LateralTranslation
+//   y = yInitialRCM + yDeltaRCM
+//   z = zInitialRCM + zDeltaRCM
+// and the z axis of the RCM frame (the probe axis)
+//   (-sin(Pitch), -cos(Pitch) * cos(Yaw), cos(Pitch) * sin(Yaw)).
+// The entry point and treatment lie on that axis at their offsets from the
+// RCM. The probe rotation spins about the probe axis and does not move any of
+// these points. Every term is evaluated as an Eigen array expression so the
+// trigonometry runs on vectorized sin/cos across SIMD lanes instead of once per
+// call. Eigen only vectorizes sin/cos for float, so sweeps should use the float
+// kinematics.
+template < typename Scalar >
+void NeuroKinematicsT< Scalar >::ForwardKinematicsFramesBatch(
+  const Neuro_joint_batchT< Scalar >& joints, Matrix3X* rcm_positions,
+  Matrix3X* entry_point_positions, Matrix3X* treatment_positions) const
+{
+  const Eigen::Index no_of_configurations = joints.size();
 
-  // Finally calculate Base to Treatment zone using the measured transformation
-  // for RCM to Treatment
-  FK.zFrameToTreatment = zFrameToRCM * RCMToEntryPoint;
+  // Robot constants shared by every configuration
+  const Scalar yTrapezoidHypotenuseSquared = _yTrapezoidHypotenuseSquared;
+  const Scalar yTrapezoidInitialHeight     = _yTrapezoidInitialHeight;
+  const Scalar halfInitialAxialSeperation  = _initialAxialSeperation / 2;
+  const Scalar halfWidthTrapezoidTop       = _widthTrapezoidTop / 2;
 
-  return FK;
+  // Y position of RCM is found by pythagorean theorem of the axial trapezoid
+  const ArrayX yTrapezoidSide =
+    (joints.AxialHeadTranslation - joints.AxialFeetTranslation) / 2 +
+    (halfInitialAxialSeperation - halfWidthTrapezoidTop);
+  const ArrayX rcmX = _xInitialRCM + joints.LateralTranslation;
+  const ArrayX rcmY =
+    _yInitialRCM +
+    (yTrapezoidHypotenuseSquared - yTrapezoidSide.square()).sqrt() -
+    yTrapezoidInitialHeight;
+  const ArrayX rcmZ =
+    _zInitialRCM +
+    (joints.AxialFeetTranslation + joints.AxialHeadTranslation) / 2;
+
+  if (rcm_positions != NULL)
+  {
+    rcm_positions->resize(3, no_of_configurations);
+    rcm_positions->row(0) = rcmX.matrix().transpose();
+    rcm_positions->row(1) = rcmY.matrix().transpose();
+    rcm_positions->row(2) = rcmZ.matrix().transpose();
+  }
+
+  if (entry_point_positions == NULL && treatment_positions == NULL)
+  {
+    return;
+  }
+
+  // Probe axis, shared by the entry point and the treatment
+  const ArrayX cosPitch   = joints.PitchRotation.cos();
+  const ArrayX probeAxisX = -joints.PitchRotation.sin();
+  const ArrayX probeAxisY = -cosPitch * joints.YawRotation.cos();
+  const ArrayX probeAxisZ = cosPitch * joints.YawRotation.sin();
+
+  if (entry_point_positions != NULL)
+  {
+    const Scalar rcmToEntryPoint = _probe->_robotToEntry - _robotToRCMOffset;
+    entry_point_positions->resize(3, no_of_configurations);
+    entry_point_positions->row(0) =
+      (rcmX + rcmToEntryPoint * probeAxisX).matrix().transpose();
+    entry_point_positions->row(1) =
+      (rcmY + rcmToEntryPoint * probeAxisY).matrix().transpose();
+    entry_point_positions->row(2) =
+      (rcmZ + rcmToEntryPoint * probeAxisZ).matrix().transpose();
+  }
+
+  if (treatment_positions != NULL)
+  {
+    const ArrayX rcmToTreatment =
+      joints.ProbeInsertion +
+      Scalar(_probe->_robotToTreatmentAtHome - _robotToRCMOffset);
+    treatment_positions->resize(3, no_of_configurations);
+    treatment_positions->row(0) =
+      (rcmX + rcmToTreatment * probeAxisX).matrix().transpose();
+    treatment_positions->row(1) =
+      (rcmY + rcmToTreatment * probeAxisY).matrix().transpose();
+    treatment_positions->row(2) =
+      (rcmZ + rcmToTreatment * probeAxisZ).matrix().transpose();
+  }
+}
+
+// Method to calculate the Jacobians of the RCM, entry point and treatment
+// frames. The position of a frame on the probe axis at a distance d from the
+// RCM is p = pRCM + d * a, with the probe axis
+//   a = (-sin(Pitch), -cos(Pitch) * cos(Yaw), cos(Pitch) * sin(Yaw))
+// (see ForwardKinematicsFramesBatch). The RCM only moves with the axial and
+// lateral joints, the pitch and yaw swing the frame around the RCM and the
+// probe insertion moves the treatment along a. All frames share the
+// orientation zFrameToRCMPrime * Rx(Yaw) * Ry(Pitch) * Rz(ProbeRotation), so
+// the angular velocity rows are the same for every frame.
+template < typename Scalar >
+Neuro_Jacobian_outputsT< Scalar > NeuroKinematicsT< Scalar >::Jacobians(
+  Scalar AxialHeadTranslation, Scalar AxialFeetTranslation,
+  Scalar LateralTranslation, Scalar ProbeInsertion, Scalar ProbeRotation,
+  Scalar PitchRotation, Scalar YawRotation, int frames) const
+{
+  Neuro_Jacobian_outputsT< Scalar > J;
+  J.zFrameToRCM.setZero();
+  J.zFrameToEntryPoint.setZero();
+  J.zFrameToTreatment.setZero();
+
+  const Scalar cosPitch = cos(PitchRotation);
+  const Scalar sinPitch = sin(PitchRotation);
+  const Scalar cosYaw   = cos(YawRotation);
+  const Scalar sinYaw   = sin(YawRotation);
+
+  // The change of the RCM height with the axial joints follows from the
+  // derivative of the pythagorean theorem of the axial trapezoid
+  const Scalar yTrapezoidSide =
+    (AxialHeadTranslation - AxialFeetTranslation) / 2 +
+    (_initialAxialSeperation - _widthTrapezoidTop) / 2;
+  const Scalar yDeltaRCMPerAxialHead =
+    -yTrapezoidSide /
+    (2 * sqrt(_yTrapezoidHypotenuseSquared - pow(yTrapezoidSide, 2)));
+
+  Jacobian rcmJacobian = Jacobian::Zero();
+  rcmJacobian(1, 0)    = yDeltaRCMPerAxialHead;
+  rcmJacobian(2, 0)    = 0.5;
+  rcmJacobian(1, 1)    = -yDeltaRCMPerAxialHead;
+  rcmJacobian(2, 1)    = 0.5;
+  rcmJacobian(0, 2)    = 1;
+
+  // Angular velocity: the probe spins about a, the pitch about the y axis
+  // rotated by the yaw and the yaw about the x axis, all mapped to the Z-frame
+  const Vector3 probeAxis(-sinPitch, -cosPitch * cosYaw, cosPitch * sinYaw);
+  rcmJacobian.template block< 3, 1 >(3, 4) = probeAxis;
+  rcmJacobian(4, 5)                        = -sinYaw;
+  rcmJacobian(5, 5)                        = -cosYaw;
+  rcmJacobian(3, 6)                        = -1;
+
+  if (frames & NEURO_FK_RCM)
+  {
+    J.zFrameToRCM = rcmJacobian;
+  }
+
+  if (!(frames & (NEURO_FK_ENTRY_POINT | NEURO_FK_TREATMENT)))
+  {
+    return J;
+  }
+
+  // Change of the probe axis with the pitch and the yaw
+  const Vector3 probeAxisPerPitch(-cosPitch, sinPitch * cosYaw,
+                                  -sinPitch * sinYaw);
+  const Vector3 probeAxisPerYaw(0, cosPitch * sinYaw, cosPitch * cosYaw);
+
+  if (frames & NEURO_FK_ENTRY_POINT)
+  {
+    const Scalar rcmToEntryPoint = _probe->_robotToEntry - _robotToRCMOffset;
+    J.zFrameToEntryPoint         = rcmJacobian;
+    J.zFrameToEntryPoint.template block< 3, 1 >(0, 5) =
+      rcmToEntryPoint * probeAxisPerPitch;
+    J.zFrameToEntryPoint.template block< 3, 1 >(0, 6) =
+      rcmToEntryPoint * probeAxisPerYaw;
+  }
+
+  if (frames & NEURO_FK_TREATMENT)
+  {
+    const Scalar rcmToTreatment =
+      ProbeInsertion + _probe->_robotToTreatmentAtHome - _robotToRCMOffset;
+    J.zFrameToTreatment                              = rcmJacobian;
+    J.zFrameToTreatment.template block< 3, 1 >(0, 3) = probeAxis;
+    J.zFrameToTreatment.template block< 3, 1 >(0, 5) =
+      rcmToTreatment * probeAxisPerPitch;
+    J.zFrameToTreatment.template block< 3, 1 >(0, 6) =
+      rcmToTreatment * probeAxisPerYaw;
+  }
+
+  return J;
+}
+
+// Batched version of Jacobians. Entry (row, col) of the Jacobian of
+// configuration i is stored in row (row + 6 * col) of column i. Only the
+// entries that are not constant zero are written after the initial setZero.
+template < typename Scalar >
+void NeuroKinematicsT< Scalar >::JacobiansBatch(
+  const Neuro_joint_batchT< Scalar >& joints, JacobianBatch* rcm_jacobians,
+  JacobianBatch* entry_point_jacobians,
+  JacobianBatch* treatment_jacobians) const
+{
+  const Eigen::Index no_of_configurations = joints.size();
+
+  const ArrayX cosPitch = joints.PitchRotation.cos();
+  const ArrayX sinPitch = joints.PitchRotation.sin();
+  const ArrayX cosYaw   = joints.YawRotation.cos();
+  const ArrayX sinYaw   = joints.YawRotation.sin();
+
+  const ArrayX yTrapezoidSide =
+    (joints.AxialHeadTranslation - joints.AxialFeetTranslation) / 2 +
+    (_initialAxialSeperation - _widthTrapezoidTop) / 2;
+  const ArrayX yDeltaRCMPerAxialHead =
+    -yTrapezoidSide /
+    (2 * (_yTrapezoidHypotenuseSquared - yTrapezoidSide.square()).sqrt());
+
+  const ArrayX probeAxisX = -sinPitch;
+  const ArrayX probeAxisY = -cosPitch * cosYaw;
+  const ArrayX probeAxisZ = cosPitch * sinYaw;
+
+  // Writes the entries shared by every frame
+  auto storeRCMJacobian = [&](JacobianBatch& jacobians) {
+    jacobians.setZero(42, no_of_configurations);
+    jacobians.row(1 + 6 * 0) = yDeltaRCMPerAxialHead.matrix().transpose();
+    jacobians.row(2 + 6 * 0).setConstant(0.5);
+    jacobians.row(1 + 6 * 1) = -yDeltaRCMPerAxialHead.matrix().transpose();
+    jacobians.row(2 + 6 * 1).setConstant(0.5);
+    jacobians.row(0 + 6 * 2).setOnes();
+    jacobians.row(3 + 6 * 4) = probeAxisX.matrix().transpose();
+    jacobians.row(4 + 6 * 4) = probeAxisY.matrix().transpose();
+    jacobians.row(5 + 6 * 4) = probeAxisZ.matrix().transpose();
+    jacobians.row(4 + 6 * 5) = -sinYaw.matrix().transpose();
+    jacobians.row(5 + 6 * 5) = -cosYaw.matrix().transpose();
+    jacobians.row(3 + 6 * 6).setConstant(-1);
+  };
+  // Writes the pitch and yaw columns of a frame at a distance from the RCM
+  auto storeProbeAxisJacobian = [&](JacobianBatch& jacobians,
+                                    const ArrayX&  distance) {
+    jacobians.row(0 + 6 * 5) = (-distance * cosPitch).matrix().transpose();
+    jacobians.row(1 + 6 * 5) =
+      (distance * sinPitch * cosYaw).matrix().transpose();
+    jacobians.row(2 + 6 * 5) =
+      (-distance * sinPitch * sinYaw).matrix().transpose();
+    jacobians.row(1 + 6 * 6) = (distance * probeAxisZ).matrix().transpose();
+    jacobians.row(2 + 6 * 6) = (-distance * probeAxisY).matrix().transpose();
+  };
+
+  if (rcm_jacobians != NULL)
+  {
+    storeRCMJacobian(*rcm_jacobians);
+  }
+
+  if (entry_point_jacobians != NULL)
+  {
+    storeRCMJacobian(*entry_point_jacobians);
+    storeProbeAxisJacobian(
+      *entry_point_jacobians,
+      ArrayX::Constant(no_of_configurations,
+                       _probe->_robotToEntry - _robotToRCMOffset));
+  }
+
+  if (treatment_jacobians != NULL)
+  {
+    storeRCMJacobian(*treatment_jacobians);
+    storeProbeAxisJacobian(
+      *treatment_jacobians,
+      joints.ProbeInsertion +
+        Scalar(_probe->_robotToTreatmentAtHome - _robotToRCMOffset));
+    treatment_jacobians->row(0 + 6 * 3) = probeAxisX.matrix().transpose();
+    treatment_jacobians->row(1 + 6 * 3) = probeAxisY.matrix().transpose();
+    treatment_jacobians->row(2 + 6 * 3) = probeAxisZ.matrix().transpose();
+  }
 }
+
 // This method defines the inverse kinematics for the neurosurgery robot
 // Given: Vectors for the 3D location of the entry point and target point with
 // respect to the zFrame Returns: The joint values for the given approach
-Neuro_IK_outputs NeuroKinematics::InverseKinematics(
-  Eigen::Vector4d entryPointzFrame, Eigen::Vector4d targetPointzFrame)
+template < typename Scalar >
+Neuro_IK_outputsT< Scalar > NeuroKinematicsT< Scalar >::InverseKinematics(
+  Vector4 entryPointzFrame, Vector4 targetPointzFrame) const
 {
 
   // Structure to return the results of the IK
-  struct Neuro_IK_outputs IK;
+  Neuro_IK_outputsT< Scalar > IK;
 
   // Get the entry point with respect to the orientation of the zFrame
-  Eigen::Vector4d rcmToEntry = _zFrameToRCM.inverse() * entryPointzFrame;
+  Vector4 rcmToEntry = _zFrameToRCMInverse * entryPointzFrame;
 
   // Get the target point with respect to the orientation of the zFrame
-  Eigen::Vector4d rcmToTarget = _zFrameToRCM.inverse() * targetPointzFrame;
+  Vector4 rcmToTarget = _zFrameToRCMInverse * targetPointzFrame;
 
   // The yaw and pitch components of the robot rely solely on the entry point's
   // location with respect to the target point This calculation is done with
@@ -233,133 +492,70 @@ Neuro_IK_outputs NeuroKinematics::InverseKinematics(
   // TODO: Add IK for probe Rotation
   IK.ProbeRotation = 0;
 
+  // Trigonometric terms shared by the translational joints and the target pose
+  const Scalar cosPitch = cos(IK.PitchRotation);
+  const Scalar sinPitch = sin(IK.PitchRotation);
+  const Scalar cosYaw   = cos(IK.YawRotation);
+  const Scalar sinYaw   = sin(IK.YawRotation);
+  const Scalar cosProbe = cos(IK.ProbeRotation);
+  const Scalar sinProbe = sin(IK.ProbeRotation);
+
   // ==========================================================================================================
 
   // The Translational elements on the Inverse Kinematics rely on the final
   // location of the target point
-  double XEntry = entryPointzFrame(0);
-  double YEntry = entryPointzFrame(1);
-  double ZEntry = entryPointzFrame(2);
+  Scalar XEntry = entryPointzFrame(0);
+  Scalar YEntry = entryPointzFrame(1);
+  Scalar ZEntry = entryPointzFrame(2);
+
+  // Distance along the probe axis from the entry point back to the RCM
+  const Scalar entryToRCM = _robotToRCMOffset - _probe->_robotToEntry;
 
   // The Lateral Translation is given by the desired distance in x
-  IK.LateralTranslation = XEntry - _xInitialRCM -
-                          _robotToRCMOffset * sin(IK.PitchRotation) +
-                          _probe->_robotToEntry * sin(IK.PitchRotation);
+  IK.LateralTranslation = XEntry - _xInitialRCM - entryToRCM * sinPitch;
 
   // Equations calculated through the symbolic equations for the Forward
   // Kinematics Substituting known values in the FK equations yields the value
-  // for Axial Head and Feet
-  IK.AxialHeadTranslation =
-    ZEntry - _initialAxialSeperation / 2 + _widthTrapezoidTop / 2 -
-    _zInitialRCM +
-    sqrt(8 * YEntry * _yInitialRCM -
-         2 * _initialAxialSeperation * _widthTrapezoidTop -
-         4 * YEntry *
-           sqrt(-pow(_initialAxialSeperation, 2) +
-                2 * _initialAxialSeperation * _widthTrapezoidTop +
-                4 * pow(_lengthOfAxialTrapezoidSideLink, 2) -
-                pow(_widthTrapezoidTop, 2)) +
-         4 * _yInitialRCM *
-           sqrt(-pow(_initialAxialSeperation, 2) +
-                2 * _initialAxialSeperation * _widthTrapezoidTop +
-                4 * pow(_lengthOfAxialTrapezoidSideLink, 2) -
-                pow(_widthTrapezoidTop, 2)) -
-         4 * pow(YEntry, 2) + pow(_initialAxialSeperation, 2) +
-         pow(_widthTrapezoidTop, 2) - 4 * pow(_yInitialRCM, 2) -
-         4 * pow(_robotToRCMOffset, 2) * pow(cos(IK.PitchRotation), 2) *
-           pow(cos(IK.YawRotation), 2) -
-         4 * pow(_probe->_robotToEntry, 2) * pow(cos(IK.PitchRotation), 2) *
-           pow(cos(IK.YawRotation), 2) +
-         8 * _robotToRCMOffset * _probe->_robotToEntry *
-           pow(cos(IK.PitchRotation), 2) * pow(cos(IK.YawRotation), 2) +
-         8 * YEntry * _robotToRCMOffset * cos(IK.PitchRotation) *
-           cos(IK.YawRotation) -
-         8 * YEntry * _probe->_robotToEntry * cos(IK.PitchRotation) *
-           cos(IK.YawRotation) -
-         8 * _robotToRCMOffset * _yInitialRCM * cos(IK.PitchRotation) *
-           cos(IK.YawRotation) +
-         8 * _probe->_robotToEntry * _yInitialRCM * cos(IK.PitchRotation) *
-           cos(IK.YawRotation) +
-         4 * _robotToRCMOffset * cos(IK.PitchRotation) * cos(IK.YawRotation) *
-           sqrt(-pow(_initialAxialSeperation, 2) +
-                2 * _initialAxialSeperation * _widthTrapezoidTop +
-                4 * pow(_lengthOfAxialTrapezoidSideLink, 2) -
-                pow(_widthTrapezoidTop, 2)) -
-         4 * _probe->_robotToEntry * cos(IK.PitchRotation) *
-           cos(IK.YawRotation) *
-           sqrt(-pow(_initialAxialSeperation, 2) +
-                2 * _initialAxialSeperation * _widthTrapezoidTop +
-                4 * pow(_lengthOfAxialTrapezoidSideLink, 2) -
-                pow(_widthTrapezoidTop, 2))) /
-      2 +
-    _robotToRCMOffset * cos(IK.PitchRotation) * sin(IK.YawRotation) -
-    _probe->_robotToEntry * cos(IK.PitchRotation) * sin(IK.YawRotation);
-  IK.AxialFeetTranslation =
-    ZEntry + _initialAxialSeperation / 2 - _widthTrapezoidTop / 2 -
-    _zInitialRCM -
-    sqrt(8 * YEntry * _yInitialRCM -
-         2 * _initialAxialSeperation * _widthTrapezoidTop -
-         4 * YEntry *
-           sqrt(-pow(_initialAxialSeperation, 2) +
-                2 * _initialAxialSeperation * _widthTrapezoidTop +
-                4 * pow(_lengthOfAxialTrapezoidSideLink, 2) -
-                pow(_widthTrapezoidTop, 2)) +
-         4 * _yInitialRCM *
-           sqrt(-pow(_initialAxialSeperation, 2) +
-                2 * _initialAxialSeperation * _widthTrapezoidTop +
-                4 * pow(_lengthOfAxialTrapezoidSideLink, 2) -
-                pow(_widthTrapezoidTop, 2)) -
-         4 * pow(YEntry, 2) + pow(_initialAxialSeperation, 2) +
-         pow(_widthTrapezoidTop, 2) - 4 * pow(_yInitialRCM, 2) -
-         4 * pow(_robotToRCMOffset, 2) * pow(cos(IK.PitchRotation), 2) *
-           pow(cos(IK.YawRotation), 2) -
-         4 * pow(_probe->_robotToEntry, 2) * pow(cos(IK.PitchRotation), 2) *
-           pow(cos(IK.YawRotation), 2) +
-         8 * _robotToRCMOffset * _probe->_robotToEntry *
-           pow(cos(IK.PitchRotation), 2) * pow(cos(IK.YawRotation), 2) +
-         8 * YEntry * _robotToRCMOffset * cos(IK.PitchRotation) *
-           cos(IK.YawRotation) -
-         8 * YEntry * _probe->_robotToEntry * cos(IK.PitchRotation) *
-           cos(IK.YawRotation) -
-         8 * _robotToRCMOffset * _yInitialRCM * cos(IK.PitchRotation) *
-           cos(IK.YawRotation) +
-         8 * _probe->_robotToEntry * _yInitialRCM * cos(IK.PitchRotation) *
-           cos(IK.YawRotation) +
-         4 * _robotToRCMOffset * cos(IK.PitchRotation) * cos(IK.YawRotation) *
-           sqrt(-pow(_initialAxialSeperation, 2) +
-                2 * _initialAxialSeperation * _widthTrapezoidTop +
-                4 * pow(_lengthOfAxialTrapezoidSideLink, 2) -
-                pow(_widthTrapezoidTop, 2)) -
-         4 * _probe->_robotToEntry * cos(IK.PitchRotation) *
-           cos(IK.YawRotation) *
-           sqrt(-pow(_initialAxialSeperation, 2) +
-                2 * _initialAxialSeperation * _widthTrapezoidTop +
-                4 * pow(_lengthOfAxialTrapezoidSideLink, 2) -
-                pow(_widthTrapezoidTop, 2))) /
-      2 +
-    _robotToRCMOffset * cos(IK.PitchRotation) * sin(IK.YawRotation) -
-    _probe->_robotToEntry * cos(IK.PitchRotation) * sin(IK.YawRotation);
+  // for Axial Head and Feet. Collecting the symbolic solution around the RCM
+  // height above its home position reduces the square root to the side of the
+  // axial trapezoid, sqrt(L^2 - (yDeltaRCM + h0)^2), where h0 is the height
+  // of the trapezoid at the initial separation.
+  const Scalar yDeltaRCM =
+    YEntry - _yInitialRCM - entryToRCM * cosPitch * cosYaw;
+  const Scalar zDeltaRCM =
+    ZEntry - _zInitialRCM + entryToRCM * cosPitch * sinYaw;
+  const Scalar yTrapezoidSide =
+    sqrt(_yTrapezoidHypotenuseSquared -
+         pow(yDeltaRCM + _yTrapezoidInitialHeight, 2));
+
+  IK.AxialHeadTranslation = zDeltaRCM - _initialAxialSeperation / 2 +
+                            _widthTrapezoidTop / 2 + yTrapezoidSide;
+  IK.AxialFeetTranslation = zDeltaRCM + _initialAxialSeperation / 2 -
+                            _widthTrapezoidTop / 2 - yTrapezoidSide;
 
   // Probe Insertion is calculate as the distance between the entry point and
   // the target point in 3D space (with considerations for the final treatment
   // zone of the probe)
-  IK.ProbeInsertion = sqrt(pow(entryPointzFrame(0) - targetPointzFrame(0), 2) +
-                           pow(entryPointzFrame(1) - targetPointzFrame(1), 2) +
-                           pow(entryPointzFrame(2) - targetPointzFrame(2), 2)) -
-                      _probe->_robotToTreatmentAtHome + _probe->_robotToEntry;
+  IK.ProbeInsertion =
+    (entryPointzFrame.template head< 3 >() -
+     targetPointzFrame.template head< 3 >())
+      .norm() -
+    _probe->_robotToTreatmentAtHome + _probe->_robotToEntry;
 
   // Obtain basic Yaw, Pitch, and Roll Rotations
-  xRotationDueToYawRotationIK << 1, 0, 0, 0, cos(IK.YawRotation),
-    -sin(IK.YawRotation), 0, sin(IK.YawRotation), cos(IK.YawRotation);
+  Matrix3 xRotationDueToYawRotationIK;
+  Matrix3 yRotationDueToPitchRotationIK;
+  Matrix3 zRotationDueToProbeRotationIK;
+  xRotationDueToYawRotationIK << 1, 0, 0, 0, cosYaw, -sinYaw, 0, sinYaw,
+    cosYaw;
 
-  yRotationDueToPitchRotationIK << cos(IK.PitchRotation), 0,
-    sin(IK.PitchRotation), 0, 1, 0, -sin(IK.PitchRotation), 0,
-    cos(IK.PitchRotation);
+  yRotationDueToPitchRotationIK << cosPitch, 0, sinPitch, 0, 1, 0, -sinPitch, 0,
+    cosPitch;
 
-  zRotationDueToProbeRotationIK << cos(IK.ProbeRotation),
-    -sin(IK.ProbeRotation), 0, sin(IK.ProbeRotation), cos(IK.ProbeRotation), 0,
-    0, 0, 1;
+  zRotationDueToProbeRotationIK << cosProbe, -sinProbe, 0, sinProbe, cosProbe,
+    0, 0, 0, 1;
   // Calculate the XYZ Rotation
+  Matrix4 zFrameToTargetPointFinal = Matrix4::Identity();
   zFrameToTargetPointFinal.block(0, 0, 3, 3) =
     (xRotationDueToYawRotationIK * yRotationDueToPitchRotationIK *
      zRotationDueToProbeRotationIK)
@@ -376,30 +572,150 @@ Neuro_IK_outputs NeuroKinematics::InverseKinematics(
 
   return IK;
 }
+
+// Batched inverse kinematics for the sub-workspace generation. This follows
+// the same closed form as InverseKinematics with the entry point terms hoisted
+// out of the per-target evaluation. Every per-target term is evaluated as an
+// Eigen array expression so the trigonometry runs on vectorized sin/cos.
+template < typename Scalar >
+void NeuroKinematicsT< Scalar >::InverseKinematicsBatch(
+  const Vector4&                entryPointzFrame,
+  const Matrix3X&               targetPointszFrame,
+  Neuro_joint_batchT< Scalar >& joints) const
+{
+  const Eigen::Index no_of_targets = targetPointszFrame.cols();
+  joints.resize(no_of_targets);
+
+  // Terms that only depend on the entry point and the probe
+  const Matrix3 zFrameToRCMRotationInverse =
+    _zFrameToRCMInverse.template block< 3, 3 >(0, 0);
+  const Vector3 rcmToEntry =
+    (_zFrameToRCMInverse * entryPointzFrame).template head< 3 >();
+  const Scalar entryToRCM         = _robotToRCMOffset - _probe->_robotToEntry;
+  const Scalar xEntryToInitialRCM = entryPointzFrame(0) - _xInitialRCM;
+  const Scalar yEntryToInitialRCM = entryPointzFrame(1) - _yInitialRCM;
+  const Scalar zEntryToInitialRCM = entryPointzFrame(2) - _zInitialRCM;
+  const Scalar probeInsertionOffset =
+    _probe->_robotToEntry - _probe->_robotToTreatmentAtHome;
+  const Scalar yTrapezoidHypotenuseSquared = _yTrapezoidHypotenuseSquared;
+  const Scalar yTrapezoidInitialHeight     = _yTrapezoidInitialHeight;
+  const Scalar halfAxialSeperationOffset =
+    (_initialAxialSeperation - _widthTrapezoidTop) / 2;
+
+  // Vector from each target point to the entry point w.r.t the RCM orientation.
+  // The translation of _zFrameToRCM cancels out in the difference.
+  const Matrix3X targetToEntry =
+    (-zFrameToRCMRotationInverse * targetPointszFrame).colwise() + rcmToEntry;
+  const ArrayX dx = targetToEntry.row(0).transpose().array();
+  const ArrayX dy = targetToEntry.row(1).transpose().array();
+  const ArrayX dz = targetToEntry.row(2).transpose().array();
+
+  // The yaw and pitch components of the robot rely solely on the entry point's
+  // location with respect to the target point
+  joints.YawRotation =
+    Scalar(3.1415 / 2) + dz.binaryExpr(dy, [](Scalar z, Scalar y) {
+      return std::atan2(z, y);
+    });
+  joints.PitchRotation = (dx / dz).atan();
+  joints.ProbeRotation.setZero();
+
+  const ArrayX cosPitch           = joints.PitchRotation.cos();
+  const ArrayX sinPitch           = joints.PitchRotation.sin();
+  const ArrayX entryToRCMcosPitch = entryToRCM * cosPitch;
+
+  // The Lateral Translation is given by the desired distance in x
+  joints.LateralTranslation = xEntryToInitialRCM - entryToRCM * sinPitch;
+
+  // Axial Head and Feet follow from the side of the axial trapezoid, see
+  // InverseKinematics
+  const ArrayX yDeltaRCM =
+    yEntryToInitialRCM - entryToRCMcosPitch * joints.YawRotation.cos();
+  const ArrayX zDeltaRCM =
+    zEntryToInitialRCM + entryToRCMcosPitch * joints.YawRotation.sin();
+  const ArrayX yTrapezoidSide =
+    (yTrapezoidHypotenuseSquared -
+     (yDeltaRCM + yTrapezoidInitialHeight).square())
+      .sqrt();
+  joints.AxialHeadTranslation =
+    zDeltaRCM - halfAxialSeperationOffset + yTrapezoidSide;
+  joints.AxialFeetTranslation =
+    zDeltaRCM + halfAxialSeperationOffset - yTrapezoidSide;
+
+  // Probe Insertion is the distance between the entry point and the target
+  // point corrected for the treatment zone of the probe
+  joints.ProbeInsertion =
+    targetToEntry.colwise().norm().transpose().array() + probeInsertionOffset;
+}
+// Method to check joint configurations against the joint limits. Each limit
+// is evaluated for the whole batch as an array comparison and the violated
+// limits are accumulated as bits, so no branch depends on the joint values.
+template < typename Scalar >
+void NeuroKinematicsT< Scalar >::CheckJointLimits(
+  const Neuro_joint_batchT< Scalar >& joints, const Neuro_joint_limits& limits,
+  ArrayXb& accepted, Eigen::ArrayXi* violations) const
+{
+  // Returns the violation bit for the values outside [min, max]. Both
+  // comparisons are false for NaN, so NaN values are out of range.
+  auto violatedLimit = [](const ArrayX& values, double min, double max,
+                          int violation) -> Eigen::ArrayXi {
+    return (!(values >= Scalar(min) && values <= Scalar(max)))
+             .template cast< int >() *
+           violation;
+  };
+
+  const ArrayX axialSeparation = _initialAxialSeperation +
+                                 joints.AxialHeadTranslation -
+                                 joints.AxialFeetTranslation;
+
+  const Eigen::ArrayXi violated_limits =
+    violatedLimit(axialSeparation, limits.min_axial_separation,
+                  limits.max_axial_separation, NEURO_LIMIT_AXIAL_SEPARATION) +
+    violatedLimit(joints.AxialHeadTranslation,
+                  limits.min_axial_head_translation,
+                  limits.max_axial_head_translation, NEURO_LIMIT_AXIAL_HEAD) +
+    violatedLimit(joints.AxialFeetTranslation,
+                  limits.min_axial_feet_translation,
+                  limits.max_axial_feet_translation, NEURO_LIMIT_AXIAL_FEET) +
+    violatedLimit(joints.LateralTranslation, limits.min_lateral_translation,
+                  limits.max_lateral_translation, NEURO_LIMIT_LATERAL) +
+    violatedLimit(joints.ProbeInsertion, limits.min_probe_insertion,
+                  limits.max_probe_insertion, NEURO_LIMIT_PROBE_INSERTION) +
+    violatedLimit(joints.PitchRotation, limits.min_pitch_rotation,
+                  limits.max_pitch_rotation, NEURO_LIMIT_PITCH) +
+    violatedLimit(joints.YawRotation, limits.min_yaw_rotation,
+                  limits.max_yaw_rotation, NEURO_LIMIT_YAW);
+
+  accepted = violated_limits == int(NEURO_LIMIT_NONE);
+  if (violations != NULL)
+  {
+    *violations = violated_limits;
+  }
+}
+
 // Method to calculate the Cartesian base location and the Pitch and Yaw
 // rotation of the robot given an EP and the RCM point as the TP.
-Neuro_IK_outputs NeuroKinematics::InverseKinematicsWithZeroProbeInsertion(
-  Eigen::Vector4d EntryPoint, Eigen::Vector4d TargetPoint)
+template < typename Scalar >
+Neuro_IK_outputsT< Scalar >
+NeuroKinematicsT< Scalar >::InverseKinematicsWithZeroProbeInsertion(
+  Vector4 EntryPoint, Vector4 TargetPoint) const
 {
   /* In this method the target point is going to be the the RCM point. The IK
   solver will try to find the values for lateral and Axial feet and Axial head
   translation that would result in the placement of the RCM on the given TP. The
   Yaw and Pitch values will be similar to the General InverseKinematics method.
   */
-  Neuro_IK_outputs IK;
+  Neuro_IK_outputsT< Scalar > IK;
   //**Temporary values**
   IK.ProbeRotation  = 0;
   IK.ProbeInsertion = 0;
 
-  double AxialHeadTranslation{}, AxialFeetTranslation{}, LateralTranslation{},
-    yTrapezoidHypotenuseSquared{}, axialTrapezoidMidpoint{};
-  double yTrapezoidSideSquared{}, yTrapezoidInitialSeparationSquared{};
-  double zDeltaRCM{}, xDeltaRCM{}, yDeltaRCM{};
+  Scalar axialTrapezoidMidpoint{};
+  Scalar zDeltaRCM{}, xDeltaRCM{}, yDeltaRCM{};
   // Get the entry point with respect to the orientation of the zFrame
-  Eigen::Vector4d rcmToEntry = _zFrameToRCM.inverse() * EntryPoint;
+  Vector4 rcmToEntry = _zFrameToRCMInverse * EntryPoint;
 
   // Get the target point with respect to the orientation of the zFrame
-  Eigen::Vector4d rcmToTarget = _zFrameToRCM.inverse() * TargetPoint;
+  Vector4 rcmToTarget = _zFrameToRCMInverse * TargetPoint;
 
   // The yaw and pitch components of the robot rely solely on the entry point's
   // location with respect to the target point This calculation is done with
@@ -409,28 +725,21 @@ Neuro_IK_outputs NeuroKinematics::InverseKinematicsWithZeroProbeInsertion(
   IK.PitchRotation =
     atan((rcmToEntry(0) - rcmToTarget(0)) / (rcmToEntry(2) - rcmToTarget(2)));
   // for the calculation of A * x = B, -->  x = inv(A) * B;
-  Eigen::Vector2d x;
-  Eigen::Matrix2d A;
+  Eigen::Matrix< Scalar, 2, 1 > x;
+  Eigen::Matrix< Scalar, 2, 2 > A;
   A << 1, -1, 1, 1;
 
-  Eigen::Vector2d B;
+  Eigen::Matrix< Scalar, 2, 1 > B;
 
   xDeltaRCM = TargetPoint(0) - _xInitialRCM;  // finding the delta values
   yDeltaRCM = TargetPoint(1) - _yInitialRCM;
   zDeltaRCM = TargetPoint(2) - _zInitialRCM;
 
-  yTrapezoidHypotenuseSquared = pow(_lengthOfAxialTrapezoidSideLink, 2);
-  yTrapezoidInitialSeparationSquared =
-    pow((_initialAxialSeperation - _widthTrapezoidTop) / 2, 2);
-
+  // Half the separation of the axial blocks follows from the height of the
+  // axial trapezoid, which is its initial height plus the change in y
   axialTrapezoidMidpoint =
-    sqrt(-1 * (pow(sqrt(yTrapezoidHypotenuseSquared -
-                        yTrapezoidInitialSeparationSquared),
-                   2) +
-               2 * yDeltaRCM *
-                 sqrt(yTrapezoidHypotenuseSquared -
-                      yTrapezoidInitialSeparationSquared) +
-               pow(yDeltaRCM, 2) - yTrapezoidHypotenuseSquared)) +
+    sqrt(_yTrapezoidHypotenuseSquared -
+         pow(yDeltaRCM + _yTrapezoidInitialHeight, 2)) +
     _widthTrapezoidTop / 2;
 
   // Finding the Lateral Translational value which is only dependant on the x
@@ -452,36 +761,38 @@ Neuro_IK_outputs NeuroKinematics::InverseKinematicsWithZeroProbeInsertion(
   return IK;
 };
 
-// Method to calculate the RCM location w.r.t Z-frame
-Neuro_FK_outputs NeuroKinematics::GetRcm(
-  double AxialHeadTranslation, double AxialFeetTranslation,
-  double LateralTranslation, double ProbeInsertion, double ProbeRotation,
-  double PitchRotation, double YawRotation)
+// Method to calculate the pose of the RCM w.r.t Z-frame. This is the part of
+// the forward kinematics shared by the RCM, entry point and treatment frames.
+template < typename Scalar >
+typename NeuroKinematicsT< Scalar >::Matrix4
+NeuroKinematicsT< Scalar >::GetZFrameToRCM(Scalar AxialHeadTranslation,
+                                                Scalar AxialFeetTranslation,
+                                                Scalar LateralTranslation,
+                                                Scalar ProbeRotation,
+                                                Scalar PitchRotation,
+                                                Scalar YawRotation) const
 {
-  // Structure to return with the FK output( struct can be remove )
-  struct Neuro_FK_outputs RCM;
-
   // Z position of RCM is solely defined as the midpoint of the axial trapezoid
-  double axialTrapezoidMidpoint =
+  Scalar axialTrapezoidMidpoint =
     (AxialHeadTranslation - AxialFeetTranslation + _initialAxialSeperation) /
     2;  // initial position
-  double zDeltaRCM = (AxialFeetTranslation + AxialHeadTranslation) / 2;
+  Scalar zDeltaRCM = (AxialFeetTranslation + AxialHeadTranslation) / 2;
 
   // Y position of RCM is found by pythagorean theorem of the axial trapezoid
-  double yTrapezoidHypotenuseSquared = pow(_lengthOfAxialTrapezoidSideLink, 2);
-  double yTrapezoidSideSquared =
+  Scalar yTrapezoidSideSquared =
     pow((axialTrapezoidMidpoint - _widthTrapezoidTop / 2), 2);
-  double yTrapezoidInitialSeparationSquared =
-    pow((_initialAxialSeperation - _widthTrapezoidTop) / 2, 2);
-  double yDeltaRCM =
-    sqrt(yTrapezoidHypotenuseSquared - yTrapezoidSideSquared) -
-    sqrt(yTrapezoidHypotenuseSquared - yTrapezoidInitialSeparationSquared);
+  Scalar yDeltaRCM =
+    sqrt(_yTrapezoidHypotenuseSquared - yTrapezoidSideSquared) -
+    _yTrapezoidInitialHeight;
 
   // X position of RCM is solely defined as the amount traveled in lateral
   // translation
-  double xDeltaRCM = LateralTranslation;
+  Scalar xDeltaRCM = LateralTranslation;
 
   // Obtain basic Yaw, Pitch, and Roll Rotations
+  Matrix3 xRotationDueToYawRotationFK;
+  Matrix3 yRotationDueToPitchRotationFK;
+  Matrix3 zRotationDueToProbeRotationFK;
   xRotationDueToYawRotationFK << 1, 0, 0, 0, cos(YawRotation),
     -sin(YawRotation), 0, sin(YawRotation), cos(YawRotation);
 
@@ -492,17 +803,25 @@ Neuro_FK_outputs NeuroKinematics::GetRcm(
     sin(ProbeRotation), cos(ProbeRotation), 0, 0, 0, 1;
 
   // Calculate the XYZ Rotation
+  Matrix4 zFrameToRCMRotation = Matrix4::Identity();
   zFrameToRCMRotation.block(0, 0, 3, 3) =
     (xRotationDueToYawRotationFK * yRotationDueToPitchRotationFK *
      zRotationDueToProbeRotationFK)
       .block(0, 0, 3, 3);
 
   // Calculate the XYZ Translation
+  Matrix4 zFrameToRCMPrime;
   zFrameToRCMPrime << -1, 0, 0, _xInitialRCM + xDeltaRCM, 0, 0, -1,
     _yInitialRCM + yDeltaRCM, 0, -1, 0, _zInitialRCM + zDeltaRCM, 0, 0, 0, 1;
 
   // Now Calculate zFrame to RCM given the calculated values above
-  Eigen::Matrix4d zFrameToRCM = zFrameToRCMPrime * zFrameToRCMRotation;
-  RCM.zFrameToTreatment       = zFrameToRCM;
-  return RCM;
-}
\ No newline at end of file
+  return zFrameToRCMPrime * zFrameToRCMRotation;
+}
+
+// Explicit instantiations for the supported scalar types
+template class NeuroKinematicsT< float >;
+template class NeuroKinematicsT< double >;
+template NeuroKinematicsT< float >::NeuroKinematicsT(
+  const NeuroKinematicsT< double >& other);
+template NeuroKinematicsT< double >::NeuroKinematicsT(
+  const NeuroKinematicsT< float >& other);
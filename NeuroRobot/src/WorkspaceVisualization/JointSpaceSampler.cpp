@@ -0,0 +1,406 @@
+#include "WorkspaceVisualization/JointSpaceSampler.hpp"
+#include "ThreadPool/ThreadPool.hpp"
+#include <algorithm>
+
+// Joints of a configuration, in the order of the FK arguments
+static double JointConfiguration::*const kJoints[] = {
+  &JointConfiguration::AxialHeadTranslation,
+  &JointConfiguration::AxialFeetTranslation,
+  &JointConfiguration::LateralTranslation,
+  &JointConfiguration::ProbeInsertion,
+  &JointConfiguration::ProbeRotation,
+  &JointConfiguration::PitchRotation,
+  &JointConfiguration::YawRotation};
+
+// Sets the joints an axis moves to their values at the given sample
+static void SetAxisJoints(const JointSpaceSampler::Axis& axis,
+                          const JointConfiguration&      value,
+                          JointConfiguration&            sample)
+{
+  for (double JointConfiguration::*joint : kJoints)
+  {
+    if (axis.step.*joint != 0)
+    {
+      sample.*joint = value.*joint;
+    }
+  }
+}
+
+// Stores a configuration as entry i of a batch
+static void SetBatchJoints(const JointConfiguration& joints, Eigen::Index i,
+                           Neuro_joint_batch& batch)
+{
+  batch.AxialHeadTranslation(i) = float(joints.AxialHeadTranslation);
+  batch.AxialFeetTranslation(i) = float(joints.AxialFeetTranslation);
+  batch.LateralTranslation(i)   = float(joints.LateralTranslation);
+  batch.ProbeInsertion(i)       = float(joints.ProbeInsertion);
+  batch.ProbeRotation(i)        = float(joints.ProbeRotation);
+  batch.PitchRotation(i)        = float(joints.PitchRotation);
+  batch.YawRotation(i)          = float(joints.YawRotation);
+}
+
+// Positions of a frame of the FK of a batch of configurations. The float
+// kinematics evaluate the whole batch with vectorized sin/cos, the positions
+// stay well within a micrometre of the double precision FK.
+static void EvaluateFrames(const NeuroKinematicsf&  kinematics,
+                           Neuro_FK_frames          frame,
+                           const Neuro_joint_batch& joints,
+                           Eigen::Matrix3Xf&        positions)
+{
+  kinematics.ForwardKinematicsFramesBatch(
+    joints, frame == NEURO_FK_RCM ? &positions : NULL,
+    frame == NEURO_FK_ENTRY_POINT ? &positions : NULL,
+    frame != NEURO_FK_RCM && frame != NEURO_FK_ENTRY_POINT ? &positions :
+                                                              NULL);
+}
+
+long JointSpaceSampler::AddPatch(const JointConfiguration&  base,
+                                 const std::vector< Axis >& axes)
+{
+  Patch patch;
+  patch.base          = base;
+  patch.axes          = axes;
+  patch.no_of_samples = 1;
+  for (const Axis& axis : axes)
+  {
+    // Accumulating the steps of every joint, joints that the axis does not
+    // move keep their base value
+    std::vector< JointConfiguration > values(std::max(axis.count, 0));
+    JointConfiguration                value = base;
+    for (int n = 0; n < axis.count; n++)
+    {
+      values[n] = value;
+      for (double JointConfiguration::*joint : kJoints)
+      {
+        value.*joint += axis.step.*joint;
+      }
+    }
+    patch.values.push_back(values);
+    patch.no_of_samples *= std::max(axis.count, 0);
+  }
+
+  PatchOffsets.push_back(NumberOfSamples);
+  NumberOfSamples += patch.no_of_samples;
+  Patches.push_back(patch);
+  return patch.no_of_samples;
+}
+
+void JointSpaceSampler::Clear()
+{
+  Patches.clear();
+  PatchOffsets.clear();
+  NumberOfSamples = 0;
+}
+
+long JointSpaceSampler::GetNumberOfSamples() const
+{
+  return NumberOfSamples;
+}
+
+const std::vector< JointSpaceSampler::Patch >&
+  JointSpaceSampler::GetPatches() const
+{
+  return Patches;
+}
+
+void JointSpaceSampler::GetSamples(long begin, long end,
+                                   JointConfiguration* samples) const
+{
+  // Patch of the first sample, empty patches are skipped by upper_bound
+  size_t p = std::upper_bound(PatchOffsets.begin(), PatchOffsets.end(), begin) -
+             PatchOffsets.begin() - 1;
+  for (long s = begin; s < end; s++)
+  {
+    while (s - PatchOffsets[p] >= Patches[p].no_of_samples)
+    {
+      p++;
+    }
+    const Patch& patch = Patches[p];
+
+    // Index of the sample along each axis, the last axis varying fastest
+    JointConfiguration& sample = samples[s - begin];
+    sample                     = patch.base;
+    long index                 = s - PatchOffsets[p];
+    for (int a = patch.axes.size() - 1; a >= 0; a--)
+    {
+      const Axis& axis = patch.axes[a];
+      SetAxisJoints(axis, patch.values[a][index % axis.count], sample);
+      index /= axis.count;
+    }
+  }
+}
+
+Eigen::Matrix3Xf JointSpaceSampler::Evaluate(const NeuroKinematics& kinematics,
+                                             Neuro_FK_frames frame) const
+{
+  Eigen::Matrix3Xf      point_set(3, NumberOfSamples);
+  const NeuroKinematicsf kinematicsf(kinematics);
+
+  // Each sample writes its own column, so the order of the points matches the
+  // patches whichever thread evaluates them
+  ThreadPool::global().parallelFor(
+    NumberOfSamples, 1024, [&](long begin, long end) {
+      std::vector< JointConfiguration > samples(end - begin);
+      GetSamples(begin, end, samples.data());
+
+      Neuro_joint_batch joints;
+      joints.resize(end - begin);
+      for (long s = begin; s < end; s++)
+      {
+        SetBatchJoints(samples[s - begin], s - begin, joints);
+      }
+      Eigen::Matrix3Xf positions;
+      EvaluateFrames(kinematicsf, frame, joints, positions);
+      point_set.middleCols(begin, end - begin) = positions;
+    });
+
+  return point_set;
+}
+
+// Advances index to the next combination of index[a] < counts[a], the last
+// axis varying fastest. Returns false once every combination was visited.
+static bool NextCombination(const std::vector< int >& counts,
+                            std::vector< int >&       index)
+{
+  for (int a = index.size() - 1; a >= 0; a--)
+  {
+    if (++index[a] < counts[a])
+    {
+      return true;
+    }
+    index[a] = 0;
+  }
+  return false;
+}
+
+// Refines the cells of a patch, see EvaluateAdaptive, and returns the
+// positions of the evaluated samples in sample order
+static std::vector< Eigen::Vector3f >
+  RefinePatch(const JointSpaceSampler::Patch& patch,
+              const NeuroKinematicsf& kinematics, Neuro_FK_frames frame,
+              double tolerance, double max_spacing, int coarse_stride)
+{
+  const int                      n = patch.axes.size();
+  std::vector< Eigen::Vector3f > refined_positions;
+  if (patch.no_of_samples == 0)
+  {
+    return refined_positions;
+  }
+
+  // Flat index of the samples, the last axis varying fastest
+  std::vector< long > flat_stride(n);
+  long                no_of_samples = 1;
+  for (int a = n - 1; a >= 0; a--)
+  {
+    flat_stride[a] = no_of_samples;
+    no_of_samples *= patch.axes[a].count;
+  }
+  std::vector< char >            evaluated(no_of_samples, 0);
+  std::vector< Eigen::Vector3f > positions(no_of_samples);
+  // Evaluates the samples of pending, given by their flat index, as one batch
+  std::vector< long > pending;
+  Neuro_joint_batch   pending_joints;
+  Eigen::Matrix3Xf    pending_positions;
+  auto                evaluate_pending = [&]() {
+    pending_joints.resize(pending.size());
+    for (size_t k = 0; k < pending.size(); k++)
+    {
+      // Outer axes are applied last, like in GetSamples
+      JointConfiguration joints = patch.base;
+      for (int a = n - 1; a >= 0; a--)
+      {
+        const int index = (pending[k] / flat_stride[a]) % patch.axes[a].count;
+        SetAxisJoints(patch.axes[a], patch.values[a][index], joints);
+      }
+      SetBatchJoints(joints, k, pending_joints);
+    }
+    EvaluateFrames(kinematics, frame, pending_joints, pending_positions);
+    for (size_t k = 0; k < pending.size(); k++)
+    {
+      positions[pending[k]] = pending_positions.col(k);
+      evaluated[pending[k]] = 1;
+    }
+    pending.clear();
+  };
+
+  // A cell spans the samples lower[a] to upper[a] along each axis, it starts
+  // as a cell of the coarse lattice
+  struct Cell
+  {
+    std::vector< int > lower, upper;
+  };
+  std::vector< Cell > cells;
+  std::vector< int >  no_of_coarse_cells(n), coarse_index(n, 0);
+  for (int a = 0; a < n; a++)
+  {
+    const int last = patch.axes[a].count - 1;
+    no_of_coarse_cells[a] =
+      std::max(1, (last + coarse_stride - 1) / coarse_stride);
+  }
+  do
+  {
+    Cell cell{std::vector< int >(n), std::vector< int >(n)};
+    for (int a = 0; a < n; a++)
+    {
+      const int last = patch.axes[a].count - 1;
+      cell.lower[a]  = std::min(coarse_index[a] * coarse_stride, last);
+      cell.upper[a]  = std::min(cell.lower[a] + coarse_stride, last);
+    }
+    cells.push_back(cell);
+  } while (NextCombination(no_of_coarse_cells, coarse_index));
+
+  std::vector< std::vector< int > > lattice(n);
+  std::vector< int >                lattice_size(n), lattice_index(n);
+  std::vector< long >               lattice_samples;
+  std::vector< Eigen::Vector3f >    lattice_positions;
+  while (!cells.empty())
+  {
+    const Cell cell = cells.back();
+    cells.pop_back();
+
+    // The corners and the midpoints of the cell along each axis
+    bool is_finest = true;
+    for (int a = 0; a < n; a++)
+    {
+      lattice[a].assign(1, cell.lower[a]);
+      if (cell.upper[a] - cell.lower[a] >= 2)
+      {
+        lattice[a].push_back((cell.lower[a] + cell.upper[a]) / 2);
+        is_finest = false;
+      }
+      if (cell.upper[a] > cell.lower[a])
+      {
+        lattice[a].push_back(cell.upper[a]);
+      }
+      lattice_size[a] = lattice[a].size();
+    }
+    // Samples are evaluated once even when they are shared by several cells,
+    // the new ones of the lattice together
+    lattice_samples.clear();
+    std::fill(lattice_index.begin(), lattice_index.end(), 0);
+    do
+    {
+      long sample = 0;
+      for (int a = 0; a < n; a++)
+      {
+        sample += lattice[a][lattice_index[a]] * flat_stride[a];
+      }
+      if (!evaluated[sample])
+      {
+        pending.push_back(sample);
+      }
+      lattice_samples.push_back(sample);
+    } while (NextCombination(lattice_size, lattice_index));
+    if (!pending.empty())
+    {
+      evaluate_pending();
+    }
+    lattice_positions.clear();
+    for (long sample : lattice_samples)
+    {
+      lattice_positions.push_back(positions[sample]);
+    }
+    if (is_finest)
+    {
+      continue;
+    }
+
+    // Largest distance of a midpoint to the middle of the segment between its
+    // two neighbours along an axis, and largest distance between neighbours
+    double deviation = 0., spacing = 0.;
+    size_t l         = 0;
+    std::fill(lattice_index.begin(), lattice_index.end(), 0);
+    do
+    {
+      // Next sample along each axis, the last axis is the fastest
+      size_t neighbour_offset = 1;
+      for (int a = n - 1; a >= 0; a--)
+      {
+        if (lattice_index[a] + 1 < lattice_size[a])
+        {
+          const Eigen::Vector3f& next = lattice_positions[l + neighbour_offset];
+          spacing = std::max(spacing,
+                             double((next - lattice_positions[l]).norm()));
+        }
+        if (lattice_size[a] == 3 && lattice_index[a] == 1)
+        {
+          const Eigen::Vector3d middle =
+            0.5 * (lattice_positions[l - neighbour_offset].cast< double >() +
+                   lattice_positions[l + neighbour_offset].cast< double >());
+          deviation = std::max(
+            deviation, (lattice_positions[l].cast< double >() - middle).norm());
+        }
+        neighbour_offset *= lattice_size[a];
+      }
+      l++;
+    } while (NextCombination(lattice_size, lattice_index));
+
+    if (deviation <= tolerance && (max_spacing <= 0. || spacing <= max_spacing))
+    {
+      continue;
+    }
+
+    // Splitting the cell in two along every axis that can be split
+    std::vector< int > halves(n), half(n, 0);
+    for (int a = 0; a < n; a++)
+    {
+      halves[a] = lattice_size[a] == 3 ? 2 : 1;
+    }
+    do
+    {
+      Cell sub_cell = cell;
+      for (int a = 0; a < n; a++)
+      {
+        if (halves[a] == 2)
+        {
+          (half[a] ? sub_cell.lower[a] : sub_cell.upper[a]) = lattice[a][1];
+        }
+      }
+      cells.push_back(sub_cell);
+    } while (NextCombination(halves, half));
+  }
+
+  for (long s = 0; s < no_of_samples; s++)
+  {
+    if (evaluated[s])
+    {
+      refined_positions.push_back(positions[s]);
+    }
+  }
+  return refined_positions;
+}
+
+Eigen::Matrix3Xf JointSpaceSampler::EvaluateAdaptive(
+  const NeuroKinematics& kinematics, Neuro_FK_frames frame, double tolerance,
+  double max_spacing, int coarse_stride) const
+{
+  // Patches are refined in parallel and concatenated in patch order
+  std::vector< std::vector< Eigen::Vector3f > > patch_positions(
+    Patches.size());
+  const NeuroKinematicsf kinematicsf(kinematics);
+  ThreadPool::global().parallelFor(
+    Patches.size(), 1, [&](long begin, long end) {
+      for (long p = begin; p < end; p++)
+      {
+        patch_positions[p] =
+          RefinePatch(Patches[p], kinematicsf, frame, tolerance, max_spacing,
+                      std::max(coarse_stride, 1));
+      }
+    });
+
+  long no_of_points = 0;
+  for (const std::vector< Eigen::Vector3f >& positions : patch_positions)
+  {
+    no_of_points += positions.size();
+  }
+  Eigen::Matrix3Xf point_set(3, no_of_points);
+  long             column = 0;
+  for (const std::vector< Eigen::Vector3f >& positions : patch_positions)
+  {
+    for (const Eigen::Vector3f& point : positions)
+    {
+      point_set.col(column++) = point;
+    }
+  }
+  return point_set;
+}
@@ -1,11 +1,17 @@
 #include "WorkspaceVisualization/WorkspaceVisualization.hpp"
+#include "PointCloudBuilder/PointCloudBuilder.hpp"
 #include "PointSetUtilities/PointSetUtilities.hpp"
+#include "WorkspaceCache/WorkspaceCache.hpp"
+#include <algorithm>
+#include <list>
+#include <mutex>
 
 // A is treatment to tip, B is robot to entry, this allows us to specify how
 // close to the patient the physical robot can be, C is cannula to treatment
 //  D is the robot to treatment distance.
 
-WorkspaceVisualization::WorkspaceVisualization(NeuroKinematics& NeuroKinematics)
+WorkspaceVisualization::WorkspaceVisualization(
+  const NeuroKinematics& NeuroKinematics, const WorkspaceResolution& resolution)
   : max_leg_displacement_(71.)
   , min_leg_seperation(75.)
   , axial_head_upper_bound_(0.)
@@ -25,1280 +31,727 @@ WorkspaceVisualization::WorkspaceVisualization(NeuroKinematics& NeuroKinematics)
   , Rx_max_degree(-88.0)
   , Probe_insert_max(40)
   , Probe_insert_min(0)
-  , Lateral_resolution(15.)
-  , axial_resolution_(65.)
-  , pitch_resolution_(10.)
-  , yaw_resolution(15.)
-  , desired_resolution(30.)
-  , desired_resolution_general_ws(5.)
-  , probe_insertion_resolution(10.0)
-
+  , resolution_(resolution)
 {
-  // Counters
-  i       = 0.0;
-  j       = 0.0;
-  k       = 0.0;
-  l       = 0.0;
-  ii      = 0.0;
-  counter = 0;
-
   // Min allowed seperation 75mm
   // Max allowed seperation 146mm
   //******TODO:You have to change the Pitch Bore and Face values and swap them!!
   // meaning that the RyB_max is 37 and RyF_max is -26
   Ry = 0.0;
   Rx = 0.0;
-  // Robot axis
-  AxialHeadTranslation = 0.0;
-  AxialFeetTranslation = 0.0;
-  LateralTranslation   = 0.0;
-  PitchRotation        = 0.0;
-  YawRotation          = 0.0;
-  ProbeInsertion       = 0.0;
-  ProbeRotation        = 0.0;
-  NeuroKinematics_     = NeuroKinematics;
-  // RCM point cloud
-  rcm_point_set_ = GetRcmPointSet();  // gives nan have to look int
+  NeuroKinematics_  = NeuroKinematics;
+  NeuroKinematicsf_ = NeuroKinematicsf(NeuroKinematics);
+
+  // Joint limits used to validate the IK of the sub-workspace. The pitch
+  // limits are the swapped RyB_max and RyF_max (see the TODO above).
+  ik_joint_limits_.min_axial_separation = min_leg_seperation;
+  ik_joint_limits_.max_axial_separation =
+    min_leg_seperation + max_leg_displacement_;
+  ik_joint_limits_.min_axial_head_translation = axial_head_lower_bound_;
+  ik_joint_limits_.max_axial_head_translation = axial_head_upper_bound_;
+  ik_joint_limits_.min_axial_feet_translation = axial_feet_lower_bound_;
+  ik_joint_limits_.max_axial_feet_translation = axial_feet_upper_bound_;
+  ik_joint_limits_.min_lateral_translation    = Lateral_translation_end;
+  ik_joint_limits_.max_lateral_translation    = Lateral_translation_start;
+  ik_joint_limits_.min_pitch_rotation         = -RyB_max;
+  ik_joint_limits_.max_pitch_rotation         = -RyF_max;
+  ik_joint_limits_.min_yaw_rotation           = Rx_max;
+  ik_joint_limits_.max_yaw_rotation           = 0.0;
+  // Targets the treatment has already passed are kept, their distance to the
+  // treatment is clamped to zero
+  ik_joint_limits_.min_probe_insertion =
+    -std::numeric_limits< double >::infinity();
+  ik_joint_limits_.max_probe_insertion = Probe_insert_max;
 }
 
-// Method to generate Point cloud of the surface of general reachable Workspace
-Eigen::Matrix3Xf WorkspaceVisualization::GetGeneralWorkspace()
+void WorkspaceVisualization::SetResolution(
+  const WorkspaceResolution& resolution)
 {
-  // Matrix to store point set
-  Eigen::Matrix3Xf point_set(3, 1);
-  point_set << 0., 0., 0.;
-
-  // Object containing the 4x4 transformation matrix
-  Neuro_FK_outputs FK{};
+  resolution_ = resolution;
+  rcm_point_set_.reset();
+}
 
-  // Visualization of the top of the Workspace
-  AxialFeetTranslation = axial_feet_upper_bound_;
-  AxialHeadTranslation = axial_head_upper_bound_;
-  YawRotation          = 0;
-  PitchRotation        = 0;
-  ProbeInsertion       = Probe_insert_min;
-  counter              = 0;
+const WorkspaceResolution& WorkspaceVisualization::GetResolution() const
+{
+  return resolution_;
+}
 
-  // initial separation 143, min separation 75=> 143-75 = 68 mm
-  for (i = Top_max_travel / axial_resolution_; i >= Top_max_travel;
-       i += Top_max_travel / axial_resolution_)
+WorkspaceResolution WorkspaceVisualization::GetCoarseResolution(
+  const WorkspaceResolution& resolution, double factor)
+{
+  WorkspaceResolution coarse = resolution;
+  for (double WorkspaceResolution::*steps :
+       {&WorkspaceResolution::axial, &WorkspaceResolution::lateral,
+        &WorkspaceResolution::pitch, &WorkspaceResolution::yaw,
+        &WorkspaceResolution::probe_insertion,
+        &WorkspaceResolution::general_workspace_sides})
   {
-
-    AxialHeadTranslation += Top_max_travel / axial_resolution_;
-    AxialFeetTranslation += Top_max_travel / axial_resolution_;
-    for (k = counter = Lateral_translation_start; k >= Lateral_translation_end;
-         k += Lateral_translation_start / Lateral_resolution,
-        counter = floor(k))
-    {
-      LateralTranslation = k;
-      if (counter == floor(Lateral_translation_start))
-      {
-        for (j = 0; j <= RyB_max; j += RyB_max / pitch_resolution_)
-        {
-          PitchRotation = j;
-          FK            = NeuroKinematics_.ForwardKinematics(
-            AxialHeadTranslation, AxialFeetTranslation, LateralTranslation,
-            ProbeInsertion, ProbeRotation, PitchRotation, YawRotation);
-          StorePointToEigenMatrix(point_set, FK.zFrameToTreatment);
-        }
-        PitchRotation = 0;
-      }
-      else if (counter == floor(Lateral_translation_end))
-      {
-        for (j = 0; j >= RyF_max; j += RyF_max / pitch_resolution_)
-        {
-          PitchRotation = j;
-          FK            = NeuroKinematics_.ForwardKinematics(
-            AxialHeadTranslation, AxialFeetTranslation, LateralTranslation,
-            ProbeInsertion, ProbeRotation, PitchRotation, YawRotation);
-          StorePointToEigenMatrix(point_set, FK.zFrameToTreatment);
-        }
-        PitchRotation = 0;
-      }
-      else
-      {
-        FK = NeuroKinematics_.ForwardKinematics(
-          AxialHeadTranslation, AxialFeetTranslation, LateralTranslation,
-          ProbeInsertion, ProbeRotation, PitchRotation, YawRotation);
-        StorePointToEigenMatrix(point_set, FK.zFrameToTreatment);
-      }
-    }
+    coarse.*steps = std::max(1., resolution.*steps / factor);
   }
+  return coarse;
+}
 
-  // loop for visualizing the bottom
-  ProbeInsertion = Probe_insert_max;
-  // The combination of 0 for head and -3 for feet gives max seperation (146)
-  // for bottom WS generation
-  AxialFeetTranslation = -3;
-  AxialHeadTranslation = axial_head_upper_bound_;
-  for (i = 0; round(i) >= round(Bottom_max_travel);
-       i += Bottom_max_travel / axial_resolution_)
-  {
-    AxialHeadTranslation += Bottom_max_travel / axial_resolution_;
-    AxialFeetTranslation += Bottom_max_travel / axial_resolution_;
-    for (k = counter = Lateral_translation_start; k >= Lateral_translation_end;
-         k += Lateral_translation_start / Lateral_resolution,
-        counter = floor(k))
-    {
-      LateralTranslation = k;
-      // only for the last row at the feet side
-      if (round(i) == round(Bottom_max_travel) || round(i) == round(0.))
-      {
-        for (j = Probe_insert_max / probe_insertion_resolution;
-             round(j) <= Probe_insert_max;
-             j += Probe_insert_max / probe_insertion_resolution)
-        {
-          ProbeInsertion = j;
-          FK             = NeuroKinematics_.ForwardKinematics(
-            AxialHeadTranslation, AxialFeetTranslation, LateralTranslation,
-            ProbeInsertion, ProbeRotation, PitchRotation, YawRotation);
-          StorePointToEigenMatrix(point_set, FK.zFrameToTreatment);
-        }
-        ProbeInsertion = Probe_insert_max;
-      }
-      if (counter == floor(Lateral_translation_start))
-      {
-        for (j = 0; j >= RyF_max; j += RyF_max / 3)
-        {
-          PitchRotation = j;
-          FK            = NeuroKinematics_.ForwardKinematics(
-            AxialHeadTranslation, AxialFeetTranslation, LateralTranslation,
-            ProbeInsertion, ProbeRotation, PitchRotation, YawRotation);
-          StorePointToEigenMatrix(point_set, FK.zFrameToTreatment);
-        }
-      }
-      else if (counter == floor(Lateral_translation_end))
-      {
-        for (j = 0; j <= RyB_max; j += RyB_max / 3)
-        {
-          PitchRotation = j;
-          FK            = NeuroKinematics_.ForwardKinematics(
-            AxialHeadTranslation, AxialFeetTranslation, LateralTranslation,
-            ProbeInsertion, ProbeRotation, PitchRotation, YawRotation);
-          StorePointToEigenMatrix(point_set, FK.zFrameToTreatment);
-        }
-      }
-      else
-      {
-        PitchRotation = 0;
-        FK            = NeuroKinematics_.ForwardKinematics(
-          AxialHeadTranslation, AxialFeetTranslation, LateralTranslation,
-          ProbeInsertion, ProbeRotation, PitchRotation, YawRotation);
-        StorePointToEigenMatrix(point_set, FK.zFrameToTreatment);
-      }
-    }
-  }
+uint64_t WorkspaceVisualization::GetRobotParameterHash() const
+{
+  // Bumped whenever a generator changes its output for the same parameters,
+  // which invalidates the cached workspaces
+  const double generator_version = 1.;
+
+  const double parameters[] = {
+    generator_version,
+    NeuroKinematics_._lengthOfAxialTrapezoidSideLink,
+    NeuroKinematics_._initialAxialSeperation,
+    NeuroKinematics_._widthTrapezoidTop,
+    NeuroKinematics_._xInitialRCM,
+    NeuroKinematics_._yInitialRCM,
+    NeuroKinematics_._zInitialRCM,
+    NeuroKinematics_._robotToRCMOffset,
+    max_leg_displacement_,
+    axial_head_upper_bound_,
+    axial_head_lower_bound_,
+    axial_feet_upper_bound_,
+    axial_feet_lower_bound_,
+    min_leg_seperation,
+    pi,
+    Rx_max,
+    RyF_max,
+    RyB_max,
+    Top_max_travel,
+    Bottom_max_travel,
+    Lateral_translation_start,
+    Lateral_translation_end,
+    Probe_insert_max,
+    Probe_insert_min,
+  };
 
-  YawRotation          = 0;
-  PitchRotation        = 0;
-  AxialFeetTranslation = -3;
-  AxialHeadTranslation = axial_head_upper_bound_;
-  ProbeInsertion       = Probe_insert_min;
+  uint64_t hash = WorkspaceCache::hash(parameters, sizeof(parameters));
+  return WorkspaceCache::hash(NeuroKinematics_._zFrameToRCM.data(),
+                              sizeof(double) * 16, hash);
+}
 
-  // Loop for creating the head face
-  for (int counter_j = j = -3; j <= max_leg_displacement_;
-       j += max_leg_displacement_ / Lateral_resolution, counter_j = floor(j))
-  {
-    AxialFeetTranslation = j;
-    for (k = counter = Lateral_translation_start; k >= Lateral_translation_end;
-         k += Lateral_translation_start / Lateral_resolution,
-        counter = floor(k))
-    {
-      LateralTranslation = k;
-      // Top level
-      if (counter_j == round(axial_feet_upper_bound_))
-      {
-        // Bore side
-        if (counter == round(Lateral_translation_start))
-        {
-          for (i = 0; i <= RyB_max; i += RyB_max / pitch_resolution_)
-          {
-            PitchRotation = i;
-            for (ii = 0; ii >= Rx_max; ii += Rx_max / yaw_resolution)
-            {
-              YawRotation = ii;
-              FK          = NeuroKinematics_.ForwardKinematics(
-                AxialHeadTranslation, AxialFeetTranslation, LateralTranslation,
-                ProbeInsertion, ProbeRotation, PitchRotation, YawRotation);
-              StorePointToEigenMatrix(point_set, FK.zFrameToTreatment);
-            }
-          }
-        }
-        // Face side
-        else if (counter == round(Lateral_translation_end))
-        {
-          for (i = 0; i >= RyF_max; i += RyF_max / pitch_resolution_)
-          {
-            PitchRotation = i;
-            for (ii = 0; ii >= Rx_max; ii += Rx_max / yaw_resolution)
-            {
-              YawRotation = ii;
-              FK          = NeuroKinematics_.ForwardKinematics(
-                AxialHeadTranslation, AxialFeetTranslation, LateralTranslation,
-                ProbeInsertion, ProbeRotation, PitchRotation, YawRotation);
-              StorePointToEigenMatrix(point_set, FK.zFrameToTreatment);
-            }
-          }
-        }
-        // between the bore and the face
-        else
-        {
-          for (ii = Rx_max / yaw_resolution; ii >= Rx_max;
-               ii += Rx_max / yaw_resolution)
-          {
-            PitchRotation = 0;
-            YawRotation   = ii;
-            FK            = NeuroKinematics_.ForwardKinematics(
-              AxialHeadTranslation, AxialFeetTranslation, LateralTranslation,
-              ProbeInsertion, ProbeRotation, PitchRotation, YawRotation);
-            StorePointToEigenMatrix(point_set, FK.zFrameToTreatment);
-          }
-        }
-      }
-      // Base level
-      else if (j == -3)
-      {
-        // Creating corner bore side
-        if (counter == floor(Lateral_translation_start))
-        {
-          YawRotation = Rx_max;
-          // lvl one bore side yaw lowered pitch lowering
-          for (i = 0; i <= RyB_max; i += RyB_max / pitch_resolution_)
-          {
-            PitchRotation = i;
-            for (ii = Probe_insert_min; ii <= Probe_insert_max - 10;
-                 ii += Probe_insert_max / probe_insertion_resolution)
-            {
-              ProbeInsertion = ii;
-              FK             = NeuroKinematics_.ForwardKinematics(
-                AxialHeadTranslation, AxialFeetTranslation, LateralTranslation,
-                ProbeInsertion, ProbeRotation, PitchRotation, YawRotation);
-              StorePointToEigenMatrix(point_set, FK.zFrameToTreatment);
-            }
-          }
-        }
-        // Creating corner face side
-        else if (counter == floor(Lateral_translation_end))
-        {
-          YawRotation = Rx_max;
-          // yaw lowered and increasing pitch
-          for (i = 0; i >= RyF_max; i += RyF_max / pitch_resolution_)
-          {
-            PitchRotation = i;
-            for (ii = Probe_insert_min; ii <= Probe_insert_max - 10;
-                 ii += Probe_insert_max / probe_insertion_resolution)
-            {
-              ProbeInsertion = ii;
-              FK             = NeuroKinematics_.ForwardKinematics(
-                AxialHeadTranslation, AxialFeetTranslation, LateralTranslation,
-                ProbeInsertion, ProbeRotation, PitchRotation, YawRotation);
-              StorePointToEigenMatrix(point_set, FK.zFrameToTreatment);
-            }
-          }
-        }
-        // Space between two corners
-        else
-        {
-          YawRotation   = Rx_max;
-          PitchRotation = 0;
-          for (ii = Probe_insert_min; ii <= Probe_insert_max - 10;
-               ii += Probe_insert_max / probe_insertion_resolution)
-          {
-            ProbeInsertion = ii;
-            FK             = NeuroKinematics_.ForwardKinematics(
-              AxialHeadTranslation, AxialFeetTranslation, LateralTranslation,
-              ProbeInsertion, ProbeRotation, PitchRotation, YawRotation);
-            StorePointToEigenMatrix(point_set, FK.zFrameToTreatment);
-          }
-        }
-        ProbeInsertion = Probe_insert_min;
-      }
+uint64_t WorkspaceVisualization::GetParameterHash() const
+{
+  const Probe& probe        = *NeuroKinematics_._probe;
+  const double parameters[] = {
+    probe._cannulaToTreatment,
+    probe._treatmentToTip,
+    probe._robotToEntry,
+    probe._robotToTreatmentAtHome,
+    resolution_.axial,
+    resolution_.lateral,
+    resolution_.pitch,
+    resolution_.yaw,
+    resolution_.probe_insertion,
+    resolution_.general_workspace_sides,
+    resolution_.rcm_point_set,
+    resolution_.surface_tolerance,
+  };
 
-      // Any other lvl from bottom to just a lvl before the top
-      else
-      {
-        YawRotation = Rx_max;
-        // Creating corner bore side
-        if (k == Lateral_translation_start)
-        {
-          // lvl one bore side yaw lowered pitch lowering
-          for (i = 0; i <= RyB_max; i += RyB_max / pitch_resolution_)
-          {
-            PitchRotation = i;
-            FK            = NeuroKinematics_.ForwardKinematics(
-              AxialHeadTranslation, AxialFeetTranslation, LateralTranslation,
-              ProbeInsertion, ProbeRotation, PitchRotation, YawRotation);
-            StorePointToEigenMatrix(point_set, FK.zFrameToTreatment);
-          }
-        }
-        // Creating corner face side
-        else if (counter == floor(Lateral_translation_end))
-        {
-          // level one face side yaw lowered pitch increasing
-          for (i = 0; i >= RyF_max; i += RyF_max / pitch_resolution_)
-          {
-            PitchRotation = i;
-            FK            = NeuroKinematics_.ForwardKinematics(
-              AxialHeadTranslation, AxialFeetTranslation, LateralTranslation,
-              ProbeInsertion, ProbeRotation, PitchRotation, YawRotation);
-            StorePointToEigenMatrix(point_set, FK.zFrameToTreatment);
-          }
-        }
-        // Space between two corners
-        else
-        {
-          PitchRotation = 0;
-          FK            = NeuroKinematics_.ForwardKinematics(
-            AxialHeadTranslation, AxialFeetTranslation, LateralTranslation,
-            ProbeInsertion, ProbeRotation, PitchRotation, YawRotation);
-          StorePointToEigenMatrix(point_set, FK.zFrameToTreatment);
-        }
-      }
-    }
-  }
-  YawRotation          = 0;
-  PitchRotation        = 0;
-  AxialFeetTranslation = axial_feet_lower_bound_;
-  // moving the base to the lowest configuration +3 makes leg separation 146
-  AxialHeadTranslation = axial_feet_lower_bound_ + 3;
-  ProbeInsertion       = Probe_insert_max;
-  int counter_i{};
-  // feet face first level from bottom
-  for (j = 0; j >= Rx_max; j += Rx_max / yaw_resolution)
-  {
-    YawRotation = j;
-    for (k = counter = Lateral_translation_start; k >= Lateral_translation_end;
-         k += Lateral_translation_start / Lateral_resolution,
-        counter = floor(k))
-    {
-      LateralTranslation = k;
-      // creating curved corners
-      if (counter == floor(Lateral_translation_start))
-      {
-        for (l = 0; l >= RyF_max; l += RyF_max / pitch_resolution_)
-        {
-          PitchRotation = l;
-          FK            = NeuroKinematics_.ForwardKinematics(
-            AxialHeadTranslation, AxialFeetTranslation, LateralTranslation,
-            ProbeInsertion, ProbeRotation, PitchRotation, YawRotation);
-          StorePointToEigenMatrix(point_set, FK.zFrameToTreatment);
-          PitchRotation = 0;
-        }
-      }
-      else if (counter == floor(Lateral_translation_end))
-      {
-        for (l = 0; l <= RyB_max; l += RyB_max / pitch_resolution_)
-        {
-          PitchRotation = l;
-          FK            = NeuroKinematics_.ForwardKinematics(
-            AxialHeadTranslation, AxialFeetTranslation, LateralTranslation,
-            ProbeInsertion, ProbeRotation, PitchRotation, YawRotation);
-          StorePointToEigenMatrix(point_set, FK.zFrameToTreatment);
-          PitchRotation = 0;
-        }
-      }
-      else
-      {
-        FK = NeuroKinematics_.ForwardKinematics(
-          AxialHeadTranslation, AxialFeetTranslation, LateralTranslation,
-          ProbeInsertion, ProbeRotation, PitchRotation, YawRotation);
-        StorePointToEigenMatrix(point_set, FK.zFrameToTreatment);
-      }
-    }
-  }
+  return WorkspaceCache::hash(parameters, sizeof(parameters),
+                              GetRobotParameterHash());
+}
 
-  // Feet face all other levels except the first
-  YawRotation    = Rx_max;
-  ProbeInsertion = Probe_insert_max;
-  PitchRotation  = 0;
-  for (i = counter_i = axial_feet_lower_bound_; i >= axial_head_lower_bound_;
-       i +=
-       (axial_head_lower_bound_ - axial_feet_lower_bound_) / Lateral_resolution,
-      counter_i = floor(i))
+const PointGridIndex& WorkspaceVisualization::GetRcmPointSetIndex()
+{
+  if (!rcm_point_set_)
   {
-    AxialHeadTranslation = i;
-    // Top level
-    if (counter_i == floor(axial_head_lower_bound_))
+    typedef std::pair< uint64_t, std::shared_ptr< const PointGridIndex > >
+      CacheEntry;
+    // RCM point sets of the process, the most recently used first
+    static std::mutex              cache_mutex;
+    static std::list< CacheEntry > cache;
+    const size_t                   max_cache_size = 4;
+    // Edge of the cells of the grid index in mm
+    const double grid_cell_size = 5.;
+
+    // The RCM does not depend on the probe, only on the robot and on the
+    // resolutions AddRcmPatches uses
+    const double resolution[] = {resolution_.axial, resolution_.lateral,
+                                 resolution_.rcm_point_set};
+    const uint64_t key = WorkspaceCache::hash(resolution, sizeof(resolution),
+                                              GetRobotParameterHash());
+
+    // The lock is held while generating, so concurrent instances with the
+    // same parameters wait for one sweep instead of running their own
+    std::lock_guard< std::mutex > lock(cache_mutex);
+    std::list< CacheEntry >::iterator entry =
+      std::find_if(cache.begin(), cache.end(),
+                   [key](const CacheEntry& e) { return e.first == key; });
+    if (entry != cache.end())
     {
-      for (k = Lateral_translation_start; k >= Lateral_translation_end;
-           k += Lateral_translation_start / Lateral_resolution)
-      {
-        LateralTranslation = k;
-        for (l = Probe_insert_max / 20; l <= Probe_insert_max - 10;
-             l += Probe_insert_max / 20)
-        {
-          ProbeInsertion = l;
-          YawRotation    = 0;
-
-          FK = NeuroKinematics_.ForwardKinematics(
-            AxialHeadTranslation, AxialFeetTranslation, LateralTranslation,
-            ProbeInsertion, ProbeRotation, PitchRotation, YawRotation);
-          StorePointToEigenMatrix(point_set, FK.zFrameToTreatment);
-        }
-      }
+      cache.splice(cache.begin(), cache, entry);
     }
-    // All other levels between the bottom level and the top
     else
     {
-      for (k = counter = Lateral_translation_start;
-           k >= Lateral_translation_end;
-           k += Lateral_translation_start / Lateral_resolution,
-          counter = floor(k))
+      cache.emplace_front(key, std::make_shared< const PointGridIndex >(
+                                 GetRcmPointSet(), grid_cell_size));
+      if (cache.size() > max_cache_size)
       {
-        LateralTranslation = k;
-        if (counter == floor(Lateral_translation_start))
-        {
-          for (l = 0; l >= RyF_max; l += RyF_max / yaw_resolution)
-          {
-            PitchRotation = l;
-            FK            = NeuroKinematics_.ForwardKinematics(
-              AxialHeadTranslation, AxialFeetTranslation, LateralTranslation,
-              ProbeInsertion, ProbeRotation, PitchRotation, YawRotation);
-            StorePointToEigenMatrix(point_set, FK.zFrameToTreatment);
-            PitchRotation = 0;
-          }
-        }
-        else if (counter == floor(Lateral_translation_end))
-        {
-          for (l = 0; l <= RyB_max; l += RyB_max / yaw_resolution)
-          {
-            PitchRotation = l;
-            FK            = NeuroKinematics_.ForwardKinematics(
-              AxialHeadTranslation, AxialFeetTranslation, LateralTranslation,
-              ProbeInsertion, ProbeRotation, PitchRotation, YawRotation);
-            StorePointToEigenMatrix(point_set, FK.zFrameToTreatment);
-            PitchRotation = 0;
-          }
-        }
-        else
-        {
-          FK = NeuroKinematics_.ForwardKinematics(
-            AxialHeadTranslation, AxialFeetTranslation, LateralTranslation,
-            ProbeInsertion, ProbeRotation, PitchRotation, YawRotation);
-          StorePointToEigenMatrix(point_set, FK.zFrameToTreatment);
-        }
+        cache.pop_back();
       }
     }
+    rcm_point_set_ = cache.front().second;
   }
+  return *rcm_point_set_;
+}
+
+// Side of the robot a lateral translation belongs to
+enum LateralSide
+{
+  LATERAL_BORE_SIDE,
+  LATERAL_BETWEEN,
+  LATERAL_FACE_SIDE,
+};
 
-  // loop for creating the sides
-  ProbeInsertion                    = Probe_insert_min;
-  AxialFeetTranslation              = -3;
-  AxialHeadTranslation              = axial_head_upper_bound_;
-  YawRotation                       = 0;
-  PitchRotation                     = 0;
-  double axial_feet_translation_old = AxialFeetTranslation;
-  // Loop for setting the max allowed movement for each level
-  for (double max_travel = Bottom_max_travel,
-              counter_i  = round(Bottom_max_travel);
-       max_travel >= Top_max_travel;
-       max_travel += (Top_max_travel - Bottom_max_travel) / Lateral_resolution,
-              counter_i = floor(max_travel))
+// Consecutive lateral translations on the same side of the robot
+struct LateralRun
+{
+  LateralSide side;
+  double      start;
+  int         count;
+};
+
+// Splits the lateral sweep from start towards end into runs of translations on
+// the same side. A translation is on the bore or face side when its floor is
+// the one of the start or end of the sweep.
+static std::vector< LateralRun > GetLateralRuns(double start, double end,
+                                                double step)
+{
+  std::vector< LateralRun > runs;
+  int                       counter = start;
+  for (double k = counter; k >= end; k += step, counter = floor(k))
   {
-    AxialFeetTranslation = axial_feet_translation_old;
-    // Loop for moving feet and head in each level
-    for (ii = AxialHeadTranslation = 0;
-         round(AxialHeadTranslation) >= max_travel;
-         AxialHeadTranslation += max_travel / Lateral_resolution,
-        ii = max_travel / Lateral_resolution)
+    const LateralSide side = counter == floor(start) ? LATERAL_BORE_SIDE
+                             : counter == floor(end) ? LATERAL_FACE_SIDE
+                                                     : LATERAL_BETWEEN;
+    if (runs.empty() || runs.back().side != side)
     {
-      AxialFeetTranslation += ii;
-
-      for (k = Lateral_translation_start;
-           round(k) >= round(Lateral_translation_end);
-           k += Lateral_translation_start / desired_resolution_general_ws)
-      {
-        LateralTranslation = k;
-        for (i = 0.; i >= Rx_max; i += Rx_max / desired_resolution_general_ws)
-        {
-          YawRotation = i;
-          for (j = RyF_max; j <= RyB_max;
-               j += (RyB_max - RyF_max) / desired_resolution_general_ws)
-          {
-            PitchRotation = j;
-            for (l = 0.; round(l) <= round(Probe_insert_max);
-                 l += Probe_insert_max / desired_resolution_general_ws)
-            {
-              ProbeInsertion = l;
-              FK             = NeuroKinematics_.ForwardKinematics(
-                AxialHeadTranslation, AxialFeetTranslation, LateralTranslation,
-                ProbeInsertion, ProbeRotation, PitchRotation, YawRotation);
-              StorePointToEigenMatrix(point_set, FK.zFrameToTreatment);
-            }
-          }
-        }
-      }
+      runs.push_back({side, k, 0});
     }
-    axial_feet_translation_old -=
-      (Top_max_travel - Bottom_max_travel) / Lateral_resolution;
+    runs.back().count++;
   }
+  return runs;
+}
 
-  return point_set;
+// Axis sweeping a single joint
+static JointSpaceSampler::Axis MakeAxis(double JointConfiguration::*joint,
+                                        double step, int count)
+{
+  JointSpaceSampler::Axis axis{};
+  axis.step.*joint = step;
+  axis.count       = count;
+  return axis;
+}
+
+// Axis moving the axial head and feet together
+static JointSpaceSampler::Axis MakeAxialAxis(double step, int count)
+{
+  JointSpaceSampler::Axis axis =
+    MakeAxis(&JointConfiguration::AxialHeadTranslation, step, count);
+  axis.step.AxialFeetTranslation = step;
+  return axis;
 }
 
-// Method to generate total entry point workspace
 // Method to generate Point cloud of the surface of general reachable Workspace
+Eigen::Matrix3Xf WorkspaceVisualization::GetGeneralWorkspace()
+{
+  JointSpaceSampler sampler;
+  AddWorkspaceSurfacePatches(sampler, true);
+  if (resolution_.surface_tolerance > 0.)
+  {
+    return sampler.EvaluateAdaptive(NeuroKinematics_, NEURO_FK_TREATMENT,
+                                    resolution_.surface_tolerance, 0.);
+  }
+  return sampler.Evaluate(NeuroKinematics_, NEURO_FK_TREATMENT);
+}
+
+// Method to generate total entry point workspace
 Eigen::Matrix3Xf WorkspaceVisualization::GetEntryPointWorkspace()
 {
-  // Matrix to store point set
-  Eigen::Matrix3Xf point_set(3, 1);
-  point_set << 0., 0., 0.;
-
-  // Object containing the 4x4 transformation matrix
-  Neuro_FK_outputs FK{};
-
-  // Visualization of the top of the Workspace
-  AxialFeetTranslation = axial_feet_upper_bound_;
-  AxialHeadTranslation = axial_head_upper_bound_;
-  YawRotation          = 0;
-  PitchRotation        = 0;
-  ProbeInsertion       = Probe_insert_min;
-  counter              = 0;
-
-  for (i = Top_max_travel / axial_resolution_; i >= Top_max_travel;
-       i += Top_max_travel / axial_resolution_)
+  JointSpaceSampler sampler;
+  AddWorkspaceSurfacePatches(sampler, false);
+  if (resolution_.surface_tolerance > 0.)
   {
+    return sampler.EvaluateAdaptive(NeuroKinematics_, NEURO_FK_ENTRY_POINT,
+                                    resolution_.surface_tolerance, 0.);
+  }
+  return sampler.Evaluate(NeuroKinematics_, NEURO_FK_ENTRY_POINT);
+}
+
+// Method to describe the surface of the general and entry point workspaces
+void WorkspaceVisualization::AddWorkspaceSurfacePatches(
+  JointSpaceSampler& sampler, bool sweep_probe_insertion)
+{
+  typedef JointSpaceSampler            Sampler;
+  typedef std::vector< Sampler::Axis > Axes;
+  const WorkspaceResolution&           res = resolution_;
+
+  // Lateral sweep shared by the top, bottom, head and feet faces
+  const double lateral_step = Lateral_translation_start / res.lateral;
+  const std::vector< LateralRun > lateral_runs =
+    GetLateralRuns(Lateral_translation_start, Lateral_translation_end,
+                   lateral_step);
+  auto lateral_axis = [&](const LateralRun& run) {
+    return MakeAxis(&JointConfiguration::LateralTranslation, lateral_step,
+                    run.count);
+  };
 
-    AxialHeadTranslation += Top_max_travel / axial_resolution_;
-    AxialFeetTranslation += Top_max_travel / axial_resolution_;
-    for (k = counter = Lateral_translation_start; k >= Lateral_translation_end;
-         k += Lateral_translation_start / Lateral_resolution,
-        counter = floor(k))
+  // Pitch sweeps from 0 to either limit
+  auto pitch_axis = [](double limit, double resolution) {
+    return MakeAxis(&JointConfiguration::PitchRotation, limit / resolution,
+                    Sampler::GetStepCount(0., limit / resolution, limit));
+  };
+  const Sampler::Axis pitch_ryb = pitch_axis(RyB_max, res.pitch);
+  const Sampler::Axis pitch_ryf = pitch_axis(RyF_max, res.pitch);
+  const Sampler::Axis yaw =
+    MakeAxis(&JointConfiguration::YawRotation, Rx_max / res.yaw,
+             Sampler::GetStepCount(0., Rx_max / res.yaw, Rx_max));
+  // Appends the corner sweep of the bore or face side
+  auto add_corner = [](Axes axes, LateralSide side, const Sampler::Axis& bore,
+                       const Sampler::Axis& face) {
+    if (side == LATERAL_BORE_SIDE)
     {
-      LateralTranslation = k;
-      if (counter == floor(Lateral_translation_start))
-      {
-        for (j = 0; j <= RyB_max; j += RyB_max / pitch_resolution_)
-        {
-          PitchRotation = j;
-          FK            = NeuroKinematics_.ForwardKinematics_EntryPoint(
-            AxialHeadTranslation, AxialFeetTranslation, LateralTranslation,
-            ProbeInsertion, ProbeRotation, PitchRotation, YawRotation);
-          StorePointToEigenMatrix(point_set, FK.zFrameToTreatment);
-        }
-        PitchRotation = 0;
-      }
-      else if (counter == floor(Lateral_translation_end))
-      {
-        for (j = 0; j >= RyF_max; j += RyF_max / pitch_resolution_)
-        {
-          PitchRotation = j;
-          FK            = NeuroKinematics_.ForwardKinematics_EntryPoint(
-            AxialHeadTranslation, AxialFeetTranslation, LateralTranslation,
-            ProbeInsertion, ProbeRotation, PitchRotation, YawRotation);
-          StorePointToEigenMatrix(point_set, FK.zFrameToTreatment);
-        }
-        PitchRotation = 0;
-      }
-      else
-      {
-        FK = NeuroKinematics_.ForwardKinematics_EntryPoint(
-          AxialHeadTranslation, AxialFeetTranslation, LateralTranslation,
-          ProbeInsertion, ProbeRotation, PitchRotation, YawRotation);
-        StorePointToEigenMatrix(point_set, FK.zFrameToTreatment);
-      }
+      axes.push_back(bore);
+    }
+    else if (side == LATERAL_FACE_SIDE)
+    {
+      axes.push_back(face);
     }
+    return axes;
+  };
+
+  JointConfiguration base{};
+
+  // Top of the workspace
+  // initial separation 143, min separation 75=> 143-75 = 68 mm
+  const double  top_step = Top_max_travel / res.axial;
+  Sampler::Axis top =
+    MakeAxialAxis(top_step, Sampler::GetStepCount(top_step, top_step,
+                                                  Top_max_travel));
+  base.AxialHeadTranslation = axial_head_upper_bound_ + top_step;
+  base.AxialFeetTranslation = axial_feet_upper_bound_ + top_step;
+  base.ProbeInsertion       = Probe_insert_min;
+  for (const LateralRun& run : lateral_runs)
+  {
+    base.LateralTranslation = run.start;
+    sampler.AddPatch(base, add_corner({top, lateral_axis(run)}, run.side,
+                                      pitch_ryb, pitch_ryf));
   }
 
-  // loop for visualizing the bottom
-  ProbeInsertion = Probe_insert_max;
+  // Bottom of the workspace
   // The combination of 0 for head and -3 for feet gives max seperation (146)
   // for bottom WS generation
-  AxialFeetTranslation = -3;
-  AxialHeadTranslation = axial_head_upper_bound_;
-  for (i = 0; round(i) >= round(Bottom_max_travel);
-       i += Bottom_max_travel / axial_resolution_)
+  const double bottom_step = Bottom_max_travel / res.axial;
+  const int    no_of_rows =
+    Sampler::GetStepCount(0., bottom_step, [&](double i) {
+      return round(i) >= round(Bottom_max_travel);
+    });
+  const Sampler::Axis bottom     = MakeAxialAxis(bottom_step, no_of_rows);
+  const Sampler::Axis bottom_ryf = pitch_axis(RyF_max, 3);
+  const Sampler::Axis bottom_ryb = pitch_axis(RyB_max, 3);
+  base.AxialHeadTranslation      = axial_head_upper_bound_ + bottom_step;
+  base.AxialFeetTranslation      = -3 + bottom_step;
+  base.ProbeInsertion            = Probe_insert_max;
+  for (const LateralRun& run : lateral_runs)
   {
-    AxialHeadTranslation += Bottom_max_travel / axial_resolution_;
-    AxialFeetTranslation += Bottom_max_travel / axial_resolution_;
-    for (k = counter = Lateral_translation_start; k >= Lateral_translation_end;
-         k += Lateral_translation_start / Lateral_resolution,
-        counter = floor(k))
-    {
-      LateralTranslation = k;
-      // only for the last row at the feet side
-      if (round(i) == round(Bottom_max_travel) || round(i) == round(0.))
-      {
-
-        FK = NeuroKinematics_.ForwardKinematics_EntryPoint(
-          AxialHeadTranslation, AxialFeetTranslation, LateralTranslation,
-          ProbeInsertion, ProbeRotation, PitchRotation, YawRotation);
-        StorePointToEigenMatrix(point_set, FK.zFrameToTreatment);
-      }
-      if (counter == floor(Lateral_translation_start))
-      {
-        for (j = 0; j >= RyF_max; j += RyF_max / 3)
-        {
-          PitchRotation = j;
-          FK            = NeuroKinematics_.ForwardKinematics_EntryPoint(
-            AxialHeadTranslation, AxialFeetTranslation, LateralTranslation,
-            ProbeInsertion, ProbeRotation, PitchRotation, YawRotation);
-          StorePointToEigenMatrix(point_set, FK.zFrameToTreatment);
-        }
-      }
-      else if (counter == floor(Lateral_translation_end))
-      {
-        for (j = 0; j <= RyB_max; j += RyB_max / 3)
-        {
-          PitchRotation = j;
-          FK            = NeuroKinematics_.ForwardKinematics_EntryPoint(
-            AxialHeadTranslation, AxialFeetTranslation, LateralTranslation,
-            ProbeInsertion, ProbeRotation, PitchRotation, YawRotation);
-          StorePointToEigenMatrix(point_set, FK.zFrameToTreatment);
-        }
-      }
-      else
-      {
-        PitchRotation = 0;
-        FK            = NeuroKinematics_.ForwardKinematics_EntryPoint(
-          AxialHeadTranslation, AxialFeetTranslation, LateralTranslation,
-          ProbeInsertion, ProbeRotation, PitchRotation, YawRotation);
-        StorePointToEigenMatrix(point_set, FK.zFrameToTreatment);
-      }
-    }
+    base.LateralTranslation = run.start;
+    sampler.AddPatch(base, add_corner({bottom, lateral_axis(run)}, run.side,
+                                      bottom_ryf, bottom_ryb));
   }
 
-  YawRotation          = 0;
-  PitchRotation        = 0;
-  AxialFeetTranslation = -3;
-  AxialHeadTranslation = axial_head_upper_bound_;
-  ProbeInsertion       = Probe_insert_min;
-
-  // Loop for creating the head face
-  for (int counter_j = j = -3; j <= max_leg_displacement_;
-       j += max_leg_displacement_ / Lateral_resolution, counter_j = floor(j))
-  {
-    AxialFeetTranslation = j;
-    for (k = counter = Lateral_translation_start; k >= Lateral_translation_end;
-         k += Lateral_translation_start / Lateral_resolution,
-        counter = floor(k))
+  // The rows at both ends of the bottom are also swept in probe insertion.
+  // These sweeps keep the pitch the previous corner sweep ended at.
+  auto last_pitch = [](LateralSide side, const Sampler::Axis& bore,
+                       const Sampler::Axis& face) {
+    if (side == LATERAL_BORE_SIDE)
     {
-      LateralTranslation = k;
-      // Top level
-      if (counter_j == round(axial_feet_upper_bound_))
-      {
-        // Bore side
-        if (counter == round(Lateral_translation_start))
-        {
-          for (i = 0; i <= RyB_max; i += RyB_max / pitch_resolution_)
-          {
-            PitchRotation = i;
-            for (ii = 0; ii >= Rx_max; ii += Rx_max / yaw_resolution)
-            {
-              YawRotation = ii;
-              FK          = NeuroKinematics_.ForwardKinematics_EntryPoint(
-                AxialHeadTranslation, AxialFeetTranslation, LateralTranslation,
-                ProbeInsertion, ProbeRotation, PitchRotation, YawRotation);
-              StorePointToEigenMatrix(point_set, FK.zFrameToTreatment);
-            }
-          }
-        }
-        // Face side
-        else if (counter == round(Lateral_translation_end))
-        {
-          for (i = 0; i >= RyF_max; i += RyF_max / pitch_resolution_)
-          {
-            PitchRotation = i;
-            for (ii = 0; ii >= Rx_max; ii += Rx_max / yaw_resolution)
-            {
-              YawRotation = ii;
-              FK          = NeuroKinematics_.ForwardKinematics_EntryPoint(
-                AxialHeadTranslation, AxialFeetTranslation, LateralTranslation,
-                ProbeInsertion, ProbeRotation, PitchRotation, YawRotation);
-              StorePointToEigenMatrix(point_set, FK.zFrameToTreatment);
-            }
-          }
-        }
-        // between the bore and the face
-        else
-        {
-          for (ii = Rx_max / yaw_resolution; ii >= Rx_max;
-               ii += Rx_max / yaw_resolution)
-          {
-            PitchRotation = 0;
-            YawRotation   = ii;
-            FK            = NeuroKinematics_.ForwardKinematics_EntryPoint(
-              AxialHeadTranslation, AxialFeetTranslation, LateralTranslation,
-              ProbeInsertion, ProbeRotation, PitchRotation, YawRotation);
-            StorePointToEigenMatrix(point_set, FK.zFrameToTreatment);
-          }
-        }
-      }
-      // Base level
-      else if (j == -3)
-      {
-        // Creating corner bore side
-        if (counter == floor(Lateral_translation_start))
-        {
-          YawRotation = Rx_max;
-          // lvl one bore side yaw lowered pitch lowering
-          for (i = 0; i <= RyB_max; i += RyB_max / pitch_resolution_)
-          {
-            PitchRotation = i;
-
-            FK = NeuroKinematics_.ForwardKinematics_EntryPoint(
-              AxialHeadTranslation, AxialFeetTranslation, LateralTranslation,
-              ProbeInsertion, ProbeRotation, PitchRotation, YawRotation);
-            StorePointToEigenMatrix(point_set, FK.zFrameToTreatment);
-          }
-        }
-        // Creating corner face side
-        else if (counter == floor(Lateral_translation_end))
-        {
-          YawRotation = Rx_max;
-          // yaw lowered and increasing pitch
-          for (i = 0; i >= RyF_max; i += RyF_max / pitch_resolution_)
-          {
-            PitchRotation = i;
-
-            FK = NeuroKinematics_.ForwardKinematics_EntryPoint(
-              AxialHeadTranslation, AxialFeetTranslation, LateralTranslation,
-              ProbeInsertion, ProbeRotation, PitchRotation, YawRotation);
-            StorePointToEigenMatrix(point_set, FK.zFrameToTreatment);
-          }
-        }
-        // Space between two corners
-        else
-        {
-          YawRotation   = Rx_max;
-          PitchRotation = 0;
-          FK            = NeuroKinematics_.ForwardKinematics_EntryPoint(
-            AxialHeadTranslation, AxialFeetTranslation, LateralTranslation,
-            ProbeInsertion, ProbeRotation, PitchRotation, YawRotation);
-          StorePointToEigenMatrix(point_set, FK.zFrameToTreatment);
-        }
-      }
-
-      // Any other lvl from bottom to just a lvl before the top
-      else
-      {
-        YawRotation = Rx_max;
-        // Creating corner bore side
-        if (k == Lateral_translation_start)
-        {
-          // lvl one bore side yaw lowered pitch lowering
-          for (i = 0; i <= RyB_max; i += RyB_max / pitch_resolution_)
-          {
-            PitchRotation = i;
-            FK            = NeuroKinematics_.ForwardKinematics_EntryPoint(
-              AxialHeadTranslation, AxialFeetTranslation, LateralTranslation,
-              ProbeInsertion, ProbeRotation, PitchRotation, YawRotation);
-            StorePointToEigenMatrix(point_set, FK.zFrameToTreatment);
-          }
-        }
-        // Creating corner face side
-        else if (counter == floor(Lateral_translation_end))
-        {
-          // level one face side yaw lowered pitch increasing
-          for (i = 0; i >= RyF_max; i += RyF_max / pitch_resolution_)
-          {
-            PitchRotation = i;
-            FK            = NeuroKinematics_.ForwardKinematics_EntryPoint(
-              AxialHeadTranslation, AxialFeetTranslation, LateralTranslation,
-              ProbeInsertion, ProbeRotation, PitchRotation, YawRotation);
-            StorePointToEigenMatrix(point_set, FK.zFrameToTreatment);
-          }
-        }
-        // Space between two corners
-        else
-        {
-          PitchRotation = 0;
-          FK            = NeuroKinematics_.ForwardKinematics_EntryPoint(
-            AxialHeadTranslation, AxialFeetTranslation, LateralTranslation,
-            ProbeInsertion, ProbeRotation, PitchRotation, YawRotation);
-          StorePointToEigenMatrix(point_set, FK.zFrameToTreatment);
-        }
-      }
+      return Sampler::GetStepValue(0., bore.step.PitchRotation, bore.count - 1);
     }
-  }
-  YawRotation          = 0;
-  PitchRotation        = 0;
-  AxialFeetTranslation = axial_feet_lower_bound_;
-  // moving the base to the lowest configuration +3 makes leg separation 146
-  AxialHeadTranslation = axial_feet_lower_bound_ + 3;
-  ProbeInsertion       = Probe_insert_max;
-  int counter_i{};
-  // feet face first level from bottom
-  for (j = 0; j >= Rx_max; j += Rx_max / yaw_resolution)
-  {
-    YawRotation = j;
-    for (k = counter = Lateral_translation_start; k >= Lateral_translation_end;
-         k += Lateral_translation_start / Lateral_resolution,
-        counter = floor(k))
+    if (side == LATERAL_FACE_SIDE)
     {
-      LateralTranslation = k;
-      // creating curved corners
-      if (counter == floor(Lateral_translation_start))
-      {
-        for (l = 0; l >= RyF_max; l += RyF_max / pitch_resolution_)
-        {
-          PitchRotation = l;
-          FK            = NeuroKinematics_.ForwardKinematics_EntryPoint(
-            AxialHeadTranslation, AxialFeetTranslation, LateralTranslation,
-            ProbeInsertion, ProbeRotation, PitchRotation, YawRotation);
-          StorePointToEigenMatrix(point_set, FK.zFrameToTreatment);
-          PitchRotation = 0;
-        }
-      }
-      else if (counter == floor(Lateral_translation_end))
-      {
-        for (l = 0; l <= RyB_max; l += RyB_max / pitch_resolution_)
-        {
-          PitchRotation = l;
-          FK            = NeuroKinematics_.ForwardKinematics_EntryPoint(
-            AxialHeadTranslation, AxialFeetTranslation, LateralTranslation,
-            ProbeInsertion, ProbeRotation, PitchRotation, YawRotation);
-          StorePointToEigenMatrix(point_set, FK.zFrameToTreatment);
-          PitchRotation = 0;
-        }
-      }
-      else
-      {
-        FK = NeuroKinematics_.ForwardKinematics_EntryPoint(
-          AxialHeadTranslation, AxialFeetTranslation, LateralTranslation,
-          ProbeInsertion, ProbeRotation, PitchRotation, YawRotation);
-        StorePointToEigenMatrix(point_set, FK.zFrameToTreatment);
-      }
+      return Sampler::GetStepValue(0., face.step.PitchRotation, face.count - 1);
     }
+    return 0.;
+  };
+  const double insertion_step = Probe_insert_max / res.probe_insertion;
+  Axes         bottom_insertion;
+  base.ProbeInsertion = Probe_insert_max;
+  if (sweep_probe_insertion)
+  {
+    bottom_insertion.push_back(MakeAxis(
+      &JointConfiguration::ProbeInsertion, insertion_step,
+      Sampler::GetStepCount(insertion_step, insertion_step, [&](double j) {
+        return round(j) <= Probe_insert_max;
+      })));
+    base.ProbeInsertion = insertion_step;
   }
-
-  // Feet face all other levels except the first
-  YawRotation    = Rx_max;
-  ProbeInsertion = Probe_insert_max;
-  PitchRotation  = 0;
-  for (i = counter_i = axial_feet_lower_bound_; i >= axial_head_lower_bound_;
-       i +=
-       (axial_head_lower_bound_ - axial_feet_lower_bound_) / Lateral_resolution,
-      counter_i = floor(i))
+  for (int row = 0; row < no_of_rows; row++)
   {
-    AxialHeadTranslation = i;
-    // Top level
-    if (counter_i == floor(axial_head_lower_bound_))
+    const double i = Sampler::GetStepValue(0., bottom_step, row);
+    if (round(i) != round(Bottom_max_travel) && round(i) != round(0.))
     {
-      for (k = Lateral_translation_start; k >= Lateral_translation_end;
-           k += Lateral_translation_start / Lateral_resolution)
-      {
-        LateralTranslation = k;
-
-        YawRotation = 0;
-
-        FK = NeuroKinematics_.ForwardKinematics_EntryPoint(
-          AxialHeadTranslation, AxialFeetTranslation, LateralTranslation,
-          ProbeInsertion, ProbeRotation, PitchRotation, YawRotation);
-        StorePointToEigenMatrix(point_set, FK.zFrameToTreatment);
-      }
+      continue;
     }
-    // All other levels between the bottom level and the top
-    else
+    base.AxialHeadTranslation =
+      Sampler::GetStepValue(axial_head_upper_bound_, bottom_step, row + 1);
+    base.AxialFeetTranslation = Sampler::GetStepValue(-3, bottom_step, row + 1);
+    base.PitchRotation =
+      row == 0 ? 0.
+               : last_pitch(lateral_runs.back().side, bottom_ryf, bottom_ryb);
+    for (const LateralRun& run : lateral_runs)
     {
-      for (k = counter = Lateral_translation_start;
-           k >= Lateral_translation_end;
-           k += Lateral_translation_start / Lateral_resolution,
-          counter = floor(k))
+      // The first translation of a run follows the pitch of the previous run
+      base.LateralTranslation = run.start;
+      sampler.AddPatch(base, bottom_insertion);
+      base.PitchRotation = last_pitch(run.side, bottom_ryf, bottom_ryb);
+      if (run.count > 1)
       {
-        LateralTranslation = k;
-        if (counter == floor(Lateral_translation_start))
-        {
-          for (l = 0; l >= RyF_max; l += RyF_max / yaw_resolution)
-          {
-            PitchRotation = l;
-            FK            = NeuroKinematics_.ForwardKinematics_EntryPoint(
-              AxialHeadTranslation, AxialFeetTranslation, LateralTranslation,
-              ProbeInsertion, ProbeRotation, PitchRotation, YawRotation);
-            StorePointToEigenMatrix(point_set, FK.zFrameToTreatment);
-            PitchRotation = 0;
-          }
-        }
-        else if (counter == floor(Lateral_translation_end))
-        {
-          for (l = 0; l <= RyB_max; l += RyB_max / yaw_resolution)
-          {
-            PitchRotation = l;
-            FK            = NeuroKinematics_.ForwardKinematics_EntryPoint(
-              AxialHeadTranslation, AxialFeetTranslation, LateralTranslation,
-              ProbeInsertion, ProbeRotation, PitchRotation, YawRotation);
-            StorePointToEigenMatrix(point_set, FK.zFrameToTreatment);
-            PitchRotation = 0;
-          }
-        }
-        else
-        {
-          FK = NeuroKinematics_.ForwardKinematics_EntryPoint(
-            AxialHeadTranslation, AxialFeetTranslation, LateralTranslation,
-            ProbeInsertion, ProbeRotation, PitchRotation, YawRotation);
-          StorePointToEigenMatrix(point_set, FK.zFrameToTreatment);
-        }
+        LateralRun rest{run.side, run.start + lateral_step, run.count - 1};
+        base.LateralTranslation = rest.start;
+        Axes axes{lateral_axis(rest)};
+        axes.insert(axes.end(), bottom_insertion.begin(),
+                    bottom_insertion.end());
+        sampler.AddPatch(base, axes);
       }
     }
   }
 
-  // loop for creating the sides
-  ProbeInsertion                    = Probe_insert_min;
-  AxialFeetTranslation              = -3;
-  AxialHeadTranslation              = axial_head_upper_bound_;
-  YawRotation                       = 0;
-  PitchRotation                     = 0;
-  double axial_feet_translation_old = AxialFeetTranslation;
-  // Loop for setting the max allowed movement for each level
-  for (double max_travel = Bottom_max_travel,
-              counter_i  = round(Bottom_max_travel);
-       max_travel >= Top_max_travel;
-       max_travel += (Top_max_travel - Bottom_max_travel) / Lateral_resolution,
-              counter_i = floor(max_travel))
+  // Head face, split into its top level, its base level and the levels in
+  // between
+  enum
   {
-    AxialFeetTranslation = axial_feet_translation_old;
-    // Loop for moving feet and head in each level
-    for (ii = AxialHeadTranslation = 0;
-         round(AxialHeadTranslation) >= max_travel;
-         AxialHeadTranslation += max_travel / Lateral_resolution,
-        ii = max_travel / Lateral_resolution)
+    LEVEL_TOP,
+    LEVEL_BASE,
+    LEVEL_OTHER,
+  };
+  struct LevelRun
+  {
+    int    level;
+    double start;
+    int    count;
+  };
+  std::vector< LevelRun > level_runs;
+  const double head_face_step = max_leg_displacement_ / res.lateral;
+  int          counter_j      = -3;
+  for (double j = counter_j; j <= max_leg_displacement_;
+       j += head_face_step, counter_j = floor(j))
+  {
+    const int level = counter_j == round(axial_feet_upper_bound_) ? LEVEL_TOP
+                      : j == -3                                   ? LEVEL_BASE
+                                                                  : LEVEL_OTHER;
+    if (level_runs.empty() || level_runs.back().level != level)
     {
-      AxialFeetTranslation += ii;
-
-      for (k = Lateral_translation_start;
-           round(k) >= round(Lateral_translation_end);
-           k += Lateral_translation_start / desired_resolution_general_ws)
+      level_runs.push_back({level, j, 0});
+    }
+    level_runs.back().count++;
+  }
+  Axes head_face_insertion;
+  base.ProbeInsertion = Probe_insert_min;
+  if (sweep_probe_insertion)
+  {
+    head_face_insertion.push_back(MakeAxis(
+      &JointConfiguration::ProbeInsertion, insertion_step,
+      Sampler::GetStepCount(Probe_insert_min, insertion_step,
+                            Probe_insert_max - 10)));
+  }
+  base.AxialHeadTranslation = axial_head_upper_bound_;
+  for (const LevelRun& level_run : level_runs)
+  {
+    const Sampler::Axis levels =
+      MakeAxis(&JointConfiguration::AxialFeetTranslation, head_face_step,
+               level_run.count);
+    base.AxialFeetTranslation = level_run.start;
+    for (const LateralRun& run : lateral_runs)
+    {
+      base.LateralTranslation = run.start;
+      base.PitchRotation      = 0;
+      base.YawRotation        = Rx_max;
+      Axes axes               = add_corner({levels, lateral_axis(run)},
+                                           run.side, pitch_ryb, pitch_ryf);
+      if (level_run.level == LEVEL_TOP)
       {
-        LateralTranslation = k;
-        for (i = 0.; i >= Rx_max; i += Rx_max / desired_resolution_general_ws)
+        // Yaw is swept from 0 on the corners, from its first step in between
+        base.YawRotation      = 0;
+        Sampler::Axis top_yaw = yaw;
+        if (run.side == LATERAL_BETWEEN)
         {
-          YawRotation = i;
-          for (j = RyF_max; j <= RyB_max;
-               j += (RyB_max - RyF_max) / desired_resolution_general_ws)
-          {
-            PitchRotation = j;
-
-            FK = NeuroKinematics_.ForwardKinematics_EntryPoint(
-              AxialHeadTranslation, AxialFeetTranslation, LateralTranslation,
-              ProbeInsertion, ProbeRotation, PitchRotation, YawRotation);
-            StorePointToEigenMatrix(point_set, FK.zFrameToTreatment);
-          }
+          base.YawRotation = yaw.step.YawRotation;
+          top_yaw.count    = Sampler::GetStepCount(
+            yaw.step.YawRotation, yaw.step.YawRotation, Rx_max);
         }
+        axes.push_back(top_yaw);
       }
+      else if (level_run.level == LEVEL_BASE)
+      {
+        axes.insert(axes.end(), head_face_insertion.begin(),
+                    head_face_insertion.end());
+      }
+      sampler.AddPatch(base, axes);
     }
-    axial_feet_translation_old -=
-      (Top_max_travel - Bottom_max_travel) / Lateral_resolution;
   }
 
-  return point_set;
-}
-
-// Method to generate Point cloud of the surface of the RCM Workspace
-Eigen::Matrix3Xf WorkspaceVisualization::GetRcmWorkSpace()
-{
-  // Object containing the 4x4 transformation matrix
-  Neuro_FK_outputs RCM{};
-  // Matrix to store point set
-  Eigen::Matrix3Xf point_set(3, 1);
-  point_set << 0., 0., 0.;
-
-  //  ++++RCM Point Cloud Generation+++
-
-  // Visualization of the top of the Workspace
-  AxialFeetTranslation = axial_feet_upper_bound_;
-  AxialHeadTranslation = axial_head_upper_bound_;
-  YawRotation          = 0;
-  PitchRotation        = 0;
-  ProbeInsertion       = Probe_insert_min;
-
-  // initial separation 143, min separation 75=> 143-75 = 68 mm
-  for (i = Top_max_travel / axial_resolution_; i >= Top_max_travel;
-       i += Top_max_travel / axial_resolution_)
+  // feet face first level from bottom
+  // moving the base to the lowest configuration +3 makes leg separation 146
+  base.AxialFeetTranslation = axial_feet_lower_bound_;
+  base.AxialHeadTranslation = axial_feet_lower_bound_ + 3;
+  base.ProbeInsertion       = Probe_insert_max;
+  base.PitchRotation        = 0;
+  base.YawRotation          = 0;
+  for (const LateralRun& run : lateral_runs)
   {
-    AxialHeadTranslation += Top_max_travel / axial_resolution_;
-    AxialFeetTranslation += Top_max_travel / axial_resolution_;
-    for (k = Lateral_translation_start; k >= Lateral_translation_end;
-         k += Lateral_translation_start / Lateral_resolution)
-    {
-      LateralTranslation = k;
-      RCM = NeuroKinematics_.GetRcm(AxialHeadTranslation, AxialFeetTranslation,
-                                    LateralTranslation, ProbeInsertion,
-                                    ProbeRotation, PitchRotation, YawRotation);
-      StorePointToEigenMatrix(point_set, RCM.zFrameToTreatment);
-    }
+    base.LateralTranslation = run.start;
+    sampler.AddPatch(base, add_corner({yaw, lateral_axis(run)}, run.side,
+                                      pitch_ryf, pitch_ryb));
   }
 
-  // loop for visualizing the bottom
-  AxialHeadTranslation = axial_head_upper_bound_;
-  AxialFeetTranslation = -3;
-  for (i = 0; i >= Bottom_max_travel;
-       i += Bottom_max_travel / axial_resolution_)
+  // Feet face all other levels, the top one is swept in probe insertion
+  const double feet_face_step =
+    (axial_head_lower_bound_ - axial_feet_lower_bound_) / res.lateral;
+  int no_of_levels     = 0;
+  int no_of_top_levels = 0;
+  int counter_i        = axial_feet_lower_bound_;
+  for (double i = counter_i; i >= axial_head_lower_bound_;
+       i += feet_face_step, counter_i = floor(i))
   {
-    AxialHeadTranslation += Bottom_max_travel / axial_resolution_;
-    AxialFeetTranslation += Bottom_max_travel / axial_resolution_;
-    for (k = Lateral_translation_start; k >= Lateral_translation_end;
-         k += Lateral_translation_start / Lateral_resolution)
-    {
-      LateralTranslation = k;
-
-      RCM = NeuroKinematics_.GetRcm(AxialHeadTranslation, AxialFeetTranslation,
-                                    LateralTranslation, ProbeInsertion,
-                                    ProbeRotation, PitchRotation, YawRotation);
-      StorePointToEigenMatrix(point_set, RCM.zFrameToTreatment);
-    }
+    no_of_levels++;
+    no_of_top_levels += counter_i == floor(axial_head_lower_bound_);
   }
-
-  // Loop for creating the head face
-  AxialFeetTranslation = -3;
-  AxialHeadTranslation = axial_head_upper_bound_;
-
-  for (int counter_j = j = -3; j <= max_leg_displacement_;
-       j += max_leg_displacement_ / Lateral_resolution, counter_j = floor(j))
+  const Sampler::Axis feet_ryf = pitch_axis(RyF_max, res.yaw);
+  const Sampler::Axis feet_ryb = pitch_axis(RyB_max, res.yaw);
+  base.AxialHeadTranslation    = axial_feet_lower_bound_;
+  base.YawRotation             = Rx_max;
+  const Sampler::Axis feet_levels =
+    MakeAxis(&JointConfiguration::AxialHeadTranslation, feet_face_step,
+             no_of_levels - no_of_top_levels);
+  for (const LateralRun& run : lateral_runs)
   {
-    AxialFeetTranslation = j;
-
-    for (k = Lateral_translation_start; k >= Lateral_translation_end;
-         k += Lateral_translation_start / Lateral_resolution)
-    {
-      LateralTranslation = k;
-
-      RCM = NeuroKinematics_.GetRcm(AxialHeadTranslation, AxialFeetTranslation,
-                                    LateralTranslation, ProbeInsertion,
-                                    ProbeRotation, PitchRotation, YawRotation);
-      StorePointToEigenMatrix(point_set, RCM.zFrameToTreatment);
-    }
+    base.LateralTranslation = run.start;
+    sampler.AddPatch(base, add_corner({feet_levels, lateral_axis(run)},
+                                      run.side, feet_ryf, feet_ryb));
   }
 
-  // Loop for creating the feet face
-  AxialFeetTranslation = axial_feet_lower_bound_;
-  // moving the base to the lowest configuration +3 makes leg separation 146
-  AxialHeadTranslation = axial_feet_lower_bound_ + 3;
-
-  for (k = counter = Lateral_translation_start; k >= Lateral_translation_end;
-       k += Lateral_translation_start / Lateral_resolution, counter = floor(k))
+  const double feet_insertion_step = Probe_insert_max / 20;
+  Axes         feet_top{
+    MakeAxis(&JointConfiguration::AxialHeadTranslation, feet_face_step,
+             no_of_top_levels),
+    MakeAxis(&JointConfiguration::LateralTranslation, lateral_step,
+             Sampler::GetStepCount(Lateral_translation_start, lateral_step,
+                                   Lateral_translation_end))};
+  if (sweep_probe_insertion)
   {
-    LateralTranslation = k;
-    RCM = NeuroKinematics_.GetRcm(AxialHeadTranslation, AxialFeetTranslation,
-                                  LateralTranslation, ProbeInsertion,
-                                  ProbeRotation, PitchRotation, YawRotation);
-    StorePointToEigenMatrix(point_set, RCM.zFrameToTreatment);
+    feet_top.push_back(MakeAxis(
+      &JointConfiguration::ProbeInsertion, feet_insertion_step,
+      Sampler::GetStepCount(feet_insertion_step, feet_insertion_step,
+                            Probe_insert_max - 10)));
+    base.ProbeInsertion = feet_insertion_step;
   }
-  // Other levels
-  for (i = axial_feet_lower_bound_; i >= axial_head_lower_bound_;
-       i +=
-       (axial_head_lower_bound_ - axial_feet_lower_bound_) / Lateral_resolution)
+  base.AxialHeadTranslation = Sampler::GetStepValue(
+    axial_feet_lower_bound_, feet_face_step, no_of_levels - no_of_top_levels);
+  base.LateralTranslation = Lateral_translation_start;
+  base.YawRotation        = 0;
+  sampler.AddPatch(base, feet_top);
+
+  // Sides, the leg separation is lowered one level at a time and the feet and
+  // head are moved together within each level
+  const double side_level_step =
+    (Top_max_travel - Bottom_max_travel) / res.lateral;
+  const double side_lateral_step =
+    Lateral_translation_start / res.general_workspace_sides;
+  const double side_yaw_step = Rx_max / res.general_workspace_sides;
+  const double side_pitch_step =
+    (RyB_max - RyF_max) / res.general_workspace_sides;
+  const double side_insertion_step =
+    Probe_insert_max / res.general_workspace_sides;
+  Axes sides{
+    Sampler::Axis{},
+    MakeAxis(&JointConfiguration::LateralTranslation, side_lateral_step,
+             Sampler::GetStepCount(
+               Lateral_translation_start, side_lateral_step, [&](double k) {
+                 return round(k) >= round(Lateral_translation_end);
+               })),
+    MakeAxis(&JointConfiguration::YawRotation, side_yaw_step,
+             Sampler::GetStepCount(0., side_yaw_step, Rx_max)),
+    MakeAxis(&JointConfiguration::PitchRotation, side_pitch_step,
+             Sampler::GetStepCount(RyF_max, side_pitch_step, RyB_max))};
+  base.ProbeInsertion = Probe_insert_min;
+  if (sweep_probe_insertion)
   {
-    AxialHeadTranslation = i;
-    for (k = Lateral_translation_start; k >= Lateral_translation_end;
-         k += Lateral_translation_start / Lateral_resolution)
-    {
-      LateralTranslation = k;
-      RCM = NeuroKinematics_.GetRcm(AxialHeadTranslation, AxialFeetTranslation,
-                                    LateralTranslation, ProbeInsertion,
-                                    ProbeRotation, PitchRotation, YawRotation);
-      StorePointToEigenMatrix(point_set, RCM.zFrameToTreatment);
-    }
+    sides.push_back(MakeAxis(
+      &JointConfiguration::ProbeInsertion, side_insertion_step,
+      Sampler::GetStepCount(0., side_insertion_step, [&](double l) {
+        return round(l) <= round(Probe_insert_max);
+      })));
   }
-
-  // loop for creating the sides
-  ProbeInsertion                    = Probe_insert_min;
-  AxialFeetTranslation              = -3;
-  AxialHeadTranslation              = axial_head_upper_bound_;
-  YawRotation                       = 0;
-  PitchRotation                     = 0;
-  double axial_feet_translation_old = AxialFeetTranslation;
-  for (double max_travel = Bottom_max_travel,
-              counter_i  = round(Bottom_max_travel);
-       max_travel >= Top_max_travel;
-       max_travel += (Top_max_travel - Bottom_max_travel) / Lateral_resolution,
-              counter_i = floor(max_travel))
+  base.AxialFeetTranslation = -3;
+  base.AxialHeadTranslation = 0;
+  base.LateralTranslation   = Lateral_translation_start;
+  base.PitchRotation        = RyF_max;
+  base.YawRotation          = 0;
+  for (double max_travel = Bottom_max_travel; max_travel >= Top_max_travel;
+       max_travel += side_level_step)
   {
-    AxialFeetTranslation = axial_feet_translation_old;
-    // Loop for moving feet and head in each level
-    for (ii = AxialHeadTranslation = 0;
-         round(AxialHeadTranslation) >= max_travel;
-         AxialHeadTranslation += max_travel / Lateral_resolution,
-        ii = max_travel / Lateral_resolution)
-    {
-      AxialFeetTranslation += ii;
-      for (k = Lateral_translation_start; k >= Lateral_translation_end;
-           k += Lateral_translation_start)
-      {
-        LateralTranslation = k;
-        LateralTranslation = k;
-        RCM                = NeuroKinematics_.GetRcm(
-          AxialHeadTranslation, AxialFeetTranslation, LateralTranslation,
-          ProbeInsertion, ProbeRotation, PitchRotation, YawRotation);
-        StorePointToEigenMatrix(point_set, RCM.zFrameToTreatment);
-      }
-    }
-    axial_feet_translation_old -=
-      (Top_max_travel - Bottom_max_travel) / Lateral_resolution;
+    const double axial_step = max_travel / res.lateral;
+    sides[0] = MakeAxialAxis(
+      axial_step, Sampler::GetStepCount(0., axial_step, [&](double head) {
+        return round(head) >= max_travel;
+      }));
+    sampler.AddPatch(base, sides);
+    base.AxialFeetTranslation -= side_level_step;
   }
+}
 
-  return point_set;
+// Method to generate Point cloud of the surface of the RCM Workspace
+Eigen::Matrix3Xf WorkspaceVisualization::GetRcmWorkSpace()
+{
+  JointSpaceSampler sampler;
+  AddRcmPatches(sampler, resolution_.lateral, Lateral_translation_start);
+  return sampler.Evaluate(NeuroKinematics_, NEURO_FK_RCM);
 }
 
 // Method to generate a point set containing all RCM points
 Eigen::Matrix3Xf WorkspaceVisualization::GetRcmPointSet()
 {
-  // Object containing the 4x4 transformation matrix
-  Neuro_FK_outputs RCM{};
-  // Matrix to store point set
-  Eigen::Matrix3Xf rcm_point_set(3, 1);
-  rcm_point_set << 0., 0., 0.;
-
-  //  ++++RCM Point Cloud Generation+++
-
-  // Visualization of the top of the Workspace
-  AxialFeetTranslation = axial_feet_upper_bound_;
-  AxialHeadTranslation = axial_head_upper_bound_;
-  YawRotation          = 0;
-  PitchRotation        = 0;
-  ProbeInsertion       = Probe_insert_min;
+  JointSpaceSampler sampler;
+  AddRcmPatches(sampler, resolution_.rcm_point_set,
+                Lateral_translation_start / resolution_.rcm_point_set);
+  return sampler.Evaluate(NeuroKinematics_, NEURO_FK_RCM);
+}
 
+// Method to describe the surface of the RCM workspace
+void WorkspaceVisualization::AddRcmPatches(JointSpaceSampler& sampler,
+                                           double sides_resolution,
+                                           double sides_lateral_step)
+{
+  typedef JointSpaceSampler  Sampler;
+  const WorkspaceResolution& res = resolution_;
+
+  const double        lateral_step = Lateral_translation_start / res.lateral;
+  const Sampler::Axis lateral =
+    MakeAxis(&JointConfiguration::LateralTranslation, lateral_step,
+             Sampler::GetStepCount(Lateral_translation_start, lateral_step,
+                                   Lateral_translation_end));
+  JointConfiguration base{};
+  base.LateralTranslation = Lateral_translation_start;
+  base.ProbeInsertion     = Probe_insert_min;
+
+  // Top of the workspace
   // initial separation 143, min separation 75=> 143-75 = 68 mm
-  for (i = Top_max_travel / axial_resolution_; i >= Top_max_travel;
-       i += Top_max_travel / axial_resolution_)
+  const double top_step     = Top_max_travel / res.axial;
+  base.AxialHeadTranslation = axial_head_upper_bound_ + top_step;
+  base.AxialFeetTranslation = axial_feet_upper_bound_ + top_step;
+  sampler.AddPatch(
+    base, {MakeAxialAxis(top_step, Sampler::GetStepCount(top_step, top_step,
+                                                         Top_max_travel)),
+           lateral});
+
+  // Bottom of the workspace
+  const double bottom_step  = Bottom_max_travel / res.axial;
+  base.AxialHeadTranslation = axial_head_upper_bound_ + bottom_step;
+  base.AxialFeetTranslation = -3 + bottom_step;
+  sampler.AddPatch(
+    base, {MakeAxialAxis(bottom_step, Sampler::GetStepCount(
+                                        0., bottom_step, Bottom_max_travel)),
+           lateral});
+
+  // Head face
+  const double head_face_step = max_leg_displacement_ / res.lateral;
+  base.AxialHeadTranslation   = axial_head_upper_bound_;
+  base.AxialFeetTranslation   = -3;
+  sampler.AddPatch(
+    base, {MakeAxis(&JointConfiguration::AxialFeetTranslation, head_face_step,
+                    Sampler::GetStepCount(-3., head_face_step,
+                                          max_leg_displacement_)),
+           lateral});
+
+  // Feet face, its first level then all the others
+  // moving the base to the lowest configuration +3 makes leg separation 146
+  base.AxialFeetTranslation = axial_feet_lower_bound_;
+  base.AxialHeadTranslation = axial_feet_lower_bound_ + 3;
+  sampler.AddPatch(base, {lateral});
+  const double feet_face_step =
+    (axial_head_lower_bound_ - axial_feet_lower_bound_) / res.lateral;
+  base.AxialHeadTranslation = axial_feet_lower_bound_;
+  sampler.AddPatch(
+    base, {MakeAxis(&JointConfiguration::AxialHeadTranslation, feet_face_step,
+                    Sampler::GetStepCount(axial_feet_lower_bound_,
+                                          feet_face_step,
+                                          axial_head_lower_bound_)),
+           lateral});
+
+  // Sides
+  const double side_level_step =
+    (Top_max_travel - Bottom_max_travel) / sides_resolution;
+  const Sampler::Axis side_lateral = MakeAxis(
+    &JointConfiguration::LateralTranslation, sides_lateral_step,
+    Sampler::GetStepCount(Lateral_translation_start, sides_lateral_step,
+                          [&](double k) {
+                            return round(k) >= round(Lateral_translation_end);
+                          }));
+  base.AxialFeetTranslation = -3;
+  base.AxialHeadTranslation = 0;
+  for (double max_travel = Bottom_max_travel; max_travel >= Top_max_travel;
+       max_travel += side_level_step)
   {
-    AxialHeadTranslation += Top_max_travel / axial_resolution_;
-    AxialFeetTranslation += Top_max_travel / axial_resolution_;
-    for (k = Lateral_translation_start; k >= Lateral_translation_end;
-         k += Lateral_translation_start / Lateral_resolution)
-    {
-      LateralTranslation = k;
-      RCM = NeuroKinematics_.GetRcm(AxialHeadTranslation, AxialFeetTranslation,
-                                    LateralTranslation, ProbeInsertion,
-                                    ProbeRotation, PitchRotation, YawRotation);
-      StorePointToEigenMatrix(rcm_point_set, RCM.zFrameToTreatment);
-    }
+    const double axial_step = max_travel / sides_resolution;
+    const int    no_of_steps =
+      Sampler::GetStepCount(0., axial_step, [&](double head) {
+        return round(head) >= max_travel;
+      });
+    sampler.AddPatch(base,
+                     {MakeAxialAxis(axial_step, no_of_steps), side_lateral});
+    base.AxialFeetTranslation -= side_level_step;
   }
+}
 
-  // loop for visualizing the bottom
-  AxialHeadTranslation = axial_head_upper_bound_;
-  AxialFeetTranslation = -3;
-  for (i = 0; i >= Bottom_max_travel;
-       i += Bottom_max_travel / axial_resolution_)
-  {
-    AxialHeadTranslation += Bottom_max_travel / axial_resolution_;
-    AxialFeetTranslation += Bottom_max_travel / axial_resolution_;
-    for (k = Lateral_translation_start; k >= Lateral_translation_end;
-         k += Lateral_translation_start / Lateral_resolution)
-    {
-      LateralTranslation = k;
+// Method to return a point set based on a given EP.
+int WorkspaceVisualization::GetSubWorkspace(
+  Eigen::Vector3d ep_in_robot_coordinate, Eigen::Matrix3Xf& workspace)
+{
 
-      RCM = NeuroKinematics_.GetRcm(AxialHeadTranslation, AxialFeetTranslation,
-                                    LateralTranslation, ProbeInsertion,
-                                    ProbeRotation, PitchRotation, YawRotation);
-      StorePointToEigenMatrix(rcm_point_set, RCM.zFrameToTreatment);
-    }
-  }
+  const PointGridIndex&   rcm_index     = GetRcmPointSetIndex();
+  const Eigen::Matrix3Xf& rcm_point_set = rcm_index.getPoints();
+  // RCM offset from Robot to RCM point, radius of the sphere of CheckSphere
+  const float radius = 72.5 - NeuroKinematics_._probe->_robotToEntry;
 
-  // Loop for creating the head face
-  AxialFeetTranslation = -3;
-  AxialHeadTranslation = axial_head_upper_bound_;
+  /* Only the RCM points in the cells of the grid overlapping the sphere
+  around the EP are visited. The points of the cells inside the sphere are
+  valid, those of the cells crossing its surface are checked with the sphere
+  criteria.*/
+  std::vector< PointGridIndex::Range > inside, crossing;
+  rcm_index.querySphere(ep_in_robot_coordinate, radius, inside, crossing);
 
-  for (int counter_j = j = -3; j <= max_leg_displacement_;
-       j += max_leg_displacement_ / Lateral_resolution, counter_j = floor(j))
+  Eigen::Index no_of_candidates = 0;
+  for (const PointGridIndex::Range& range : inside)
   {
-    AxialFeetTranslation = j;
-
-    for (k = Lateral_translation_start; k >= Lateral_translation_end;
-         k += Lateral_translation_start / Lateral_resolution)
-    {
-      LateralTranslation = k;
-
-      RCM = NeuroKinematics_.GetRcm(AxialHeadTranslation, AxialFeetTranslation,
-                                    LateralTranslation, ProbeInsertion,
-                                    ProbeRotation, PitchRotation, YawRotation);
-      StorePointToEigenMatrix(rcm_point_set, RCM.zFrameToTreatment);
-    }
+    no_of_candidates += range.second - range.first;
   }
-
-  // Loop for creating the feet face
-  AxialFeetTranslation = axial_feet_lower_bound_;
-  // moving the base to the lowest configuration +3 makes leg separation 146
-  AxialHeadTranslation = axial_feet_lower_bound_ + 3;
-
-  for (k = counter = Lateral_translation_start; k >= Lateral_translation_end;
-       k += Lateral_translation_start / Lateral_resolution, counter = floor(k))
+  for (const PointGridIndex::Range& range : crossing)
   {
-    LateralTranslation = k;
-    RCM = NeuroKinematics_.GetRcm(AxialHeadTranslation, AxialFeetTranslation,
-                                  LateralTranslation, ProbeInsertion,
-                                  ProbeRotation, PitchRotation, YawRotation);
-    StorePointToEigenMatrix(rcm_point_set, RCM.zFrameToTreatment);
+    no_of_candidates += range.second - range.first;
   }
-  // Other levels
-  for (i = axial_feet_lower_bound_; i >= axial_head_lower_bound_;
-       i +=
-       (axial_head_lower_bound_ - axial_feet_lower_bound_) / Lateral_resolution)
+  // Buffer which stores the validated point set after checking the sphere
+  // condition, at most every candidate is validated
+  PointCloudBuilder validated_points(no_of_candidates);
+  for (const PointGridIndex::Range& range : inside)
   {
-    AxialHeadTranslation = i;
-    for (k = Lateral_translation_start; k >= Lateral_translation_end;
-         k += Lateral_translation_start / Lateral_resolution)
+    for (Eigen::Index i = range.first; i < range.second; i++)
     {
-      LateralTranslation = k;
-      RCM = NeuroKinematics_.GetRcm(AxialHeadTranslation, AxialFeetTranslation,
-                                    LateralTranslation, ProbeInsertion,
-                                    ProbeRotation, PitchRotation, YawRotation);
-      StorePointToEigenMatrix(rcm_point_set, RCM.zFrameToTreatment);
+      validated_points.append(rcm_point_set.col(i));
     }
   }
-
-  // loop for creating the sides
-  ProbeInsertion                    = Probe_insert_min;
-  AxialFeetTranslation              = -3;
-  AxialHeadTranslation              = axial_head_upper_bound_;
-  YawRotation                       = 0;
-  PitchRotation                     = 0;
-  double axial_feet_translation_old = AxialFeetTranslation;
-  for (double max_travel = Bottom_max_travel; max_travel >= Top_max_travel;
-       max_travel += (Top_max_travel - Bottom_max_travel) / desired_resolution)
+  for (const PointGridIndex::Range& range : crossing)
   {
-    AxialFeetTranslation = axial_feet_translation_old;
-    // Loop for moving feet and head in each level
-    for (ii = AxialHeadTranslation = 0;
-         round(AxialHeadTranslation) >= max_travel;
-         AxialHeadTranslation += max_travel / desired_resolution,
-        ii = max_travel / desired_resolution)
+    for (Eigen::Index i = range.first; i < range.second; i++)
     {
-      AxialFeetTranslation += ii;
-      for (k = Lateral_translation_start;
-           round(k) >= round(Lateral_translation_end);
-           k += Lateral_translation_start / desired_resolution)
+      if (CheckSphere(ep_in_robot_coordinate, rcm_point_set.col(i)))
       {
-        LateralTranslation = k;
-        LateralTranslation = k;
-        RCM                = NeuroKinematics_.GetRcm(
-          AxialHeadTranslation, AxialFeetTranslation, LateralTranslation,
-          ProbeInsertion, ProbeRotation, PitchRotation, YawRotation);
-        StorePointToEigenMatrix(rcm_point_set, RCM.zFrameToTreatment);
+        validated_points.append(rcm_point_set.col(i));
       }
     }
-    axial_feet_translation_old -=
-      (Top_max_travel - Bottom_max_travel) / desired_resolution;
-  }
-
-  return rcm_point_set;
-}
-
-// Method to return a point set based on a given EP.
-int WorkspaceVisualization::GetSubWorkspace(
-  Eigen::Vector3d ep_in_robot_coordinate, Eigen::Matrix3Xf& workspace)
-{
-
-  // Number of points inside the RCM pointset
-  int no_cols_rcm_pc = rcm_point_set_.cols();
-
-  Eigen::Vector3f rcm_point_to_check;
-  // Matrix which stores the validated point set after checking the sphere
-  // condition
-  Eigen::Matrix3Xf validated_point_set(3, 1);
-  /* Loop which goes through each RCM points and checks for the validity of
-  each point based on the sphere criteria.*/
-  for (int i = 0; i < no_cols_rcm_pc; i++)
-  {
-    rcm_point_to_check << rcm_point_set_(0, i), rcm_point_set_(1, i),
-      rcm_point_set_(2, i);
-    if (CheckSphere(ep_in_robot_coordinate, rcm_point_to_check) == 1)
-    {
-      StorePointToEigenMatrix(validated_point_set, rcm_point_set_(0, i),
-                              rcm_point_set_(1, i), rcm_point_set_(2, i));
-    }
   }
+  Eigen::Matrix3Xf validated_point_set = validated_points.release();
   // PointSetUtilities datawriter(validated_point_set);
-  // datawriter.saveToXyz("sphere_checked.xyz");
+  // datawriter.saveToPoints("sphere_checked.points");
   // Vector to store distance from each validated rcm points to the entry
   // point
   Eigen::VectorXd treatment_to_tp_dist(1);
@@ -1351,20 +804,15 @@ bool WorkspaceVisualization::CheckSphere(Eigen::Vector3d ep_in_robot_coordinate,
   // RCM offset from Robot to RCM point
   const float radius = 72.5 - B_value;
 
-  float distance{0};
-  distance = pow(ep_in_robot_coordinate(0) - rcm_point_set(0), 2) +
-             pow(ep_in_robot_coordinate(1) - rcm_point_set(1), 2) +
-             pow(ep_in_robot_coordinate(2) - rcm_point_set(2), 2);
+  // The squared distance is summed in double and rounded to float, the
+  // squared radius is compared in double
+  const Eigen::Vector3d difference =
+    ep_in_robot_coordinate - rcm_point_set.cast< double >();
+  const float distance = difference(0) * difference(0) +
+                         difference(1) * difference(1) +
+                         difference(2) * difference(2);
   // Entry point is inside the Sphere
-  if (distance <= pow(radius, 2))
-  {
-    return 1;
-  }
-  // Entry point is outside of the Sphere
-  else
-  {
-    return 0;
-  }
+  return distance <= double(radius) * radius;
 }
 
 /* Method to Check the IK for each point in the Validated point set and
@@ -1374,11 +822,7 @@ int WorkspaceVisualization::GetPointCloudInverseKinematics(
   Eigen::VectorXd&  treatment_to_tp_dist,
   Eigen::Matrix3Xf& sub_workspace_rcm_point_set)
 {
-  // Initializng the sub_workspace matrix
-  sub_workspace_rcm_point_set.resize(3, 1);
-  sub_workspace_rcm_point_set << 0., 0., 0.;
-
-  counter                         = 0;
+  int counter                     = 0;
   int no_cols_validated_point_set = validated_point_set.cols();
 
   /* The methods checks for validity of the filtered workspace Using
@@ -1386,115 +830,44 @@ int WorkspaceVisualization::GetPointCloudInverseKinematics(
   Eigen Vectors of size 4 i.e (x,y,z,1). First argument is the EP and the
   second argument is the RCM point which is considered as the TP.*/
 
-  // Initializing the vectors for EP and TP.
+  // Initializing the vector for the EP.
   Eigen::Vector4d ep_in_robot_coordinate(
     ep_in_robot_coordnt(0), ep_in_robot_coordnt(1), ep_in_robot_coordnt(2), 1);
-  Eigen::Vector4d tp_in_robot_coordinate(0, 0, 0, 1);
-
-  // Initializing the limits for each axis of the robot.
-  const double initial_Axial_separation  = 143;
-  const double min_Axial_separation      = 75;
-  const double max_Axial_separation      = 146;
-  const double max_Lateral_translation   = -49;
-  const double min_Lateral_translation   = -98;
-  const double max_AxialHead_translation = 0;
-  const double min_AxialHead_translation = -145;
-  const double max_AxialFeet_translation = 68;
-  const double min_AxialFeet_translation = -77;
-  const double max_Pitch_rotation        = +26.0 * pi / 180;
-  const double min_Pitch_rotation        = -37.0 * pi / 180;
-  const double max_Yaw_rotation          = 0.0 * pi / 180;
-  const double min_Yaw_rotation          = -88.0 * pi / 180;
-  const double min_Probe_insertion       = 0;
-  const double max_probe_insertion       = 40;
-  double       Axial_Seperation{0};
-
-  /* Object to store the output of the
-  InverseKinematicsWithZeroProbeInsertion method*/
-  Neuro_IK_outputs IK_output;
-
-  /* Loop that goes through each point in the Validated PC and checks for
-  the Validity of the IK output*/
-  for (i = 0; i < no_cols_validated_point_set; i++)
-  {
-    // setting the TP for each point in the loop
-    tp_in_robot_coordinate << validated_point_set(0, i),
-      validated_point_set(1, i), validated_point_set(2, i), 1;
-
-    IK_output = NeuroKinematics_.InverseKinematics(ep_in_robot_coordinate,
-                                                   tp_in_robot_coordinate);
-
-    Axial_Seperation =
-      143 + IK_output.AxialHeadTranslation - IK_output.AxialFeetTranslation;
 
-    if (Axial_Seperation > max_Axial_separation)
-    {
-      continue;
-    }
-    /*Axial Heads are farther away than the allowed value or Axial Heads are
-    closer than the allowed value.*/
-    else if (Axial_Seperation > max_Axial_separation ||
-             Axial_Seperation < min_Axial_separation)
-    {
-      continue;
-    }
-    // If Axial Head travels more than the max or min allowed range
-    else if (IK_output.AxialHeadTranslation < min_AxialHead_translation ||
-             IK_output.AxialHeadTranslation > max_AxialHead_translation)
-
-    {
-      continue;
-    }
-    // If Axial Feet travels more than the max or min allowed range
-    else if (IK_output.AxialFeetTranslation < min_AxialFeet_translation ||
-             IK_output.AxialFeetTranslation > max_AxialFeet_translation)
-    {
-      continue;
-    }
-    // If Lateral travels more than the max or min allowed range
-    else if (IK_output.LateralTranslation < min_Lateral_translation ||
-             IK_output.LateralTranslation > max_Lateral_translation)
-    {
-      continue;
-    }
-    // If Yaw rotates more than the max or min allowed range
-    else if (IK_output.YawRotation < min_Yaw_rotation ||
-             IK_output.YawRotation > max_Yaw_rotation ||
-             IK_output.YawRotation == NAN)
-    {
-      continue;
-    }
-    // If Pitch rotates more than the max or min allowed range
-    else if (IK_output.PitchRotation < min_Pitch_rotation ||
-             IK_output.PitchRotation > max_Pitch_rotation)
-    {
-      continue;
-    }
-    // If probe insertion is more or less than the allowable limits
-    else if (IK_output.ProbeInsertion > max_probe_insertion)
+  // The IK of every point is solved in a single batched pass since the EP is
+  // shared by all of them
+  Neuro_joint_batch IK_batch;
+  NeuroKinematicsf_.InverseKinematicsBatch(
+    ep_in_robot_coordinate.cast< float >(), validated_point_set, IK_batch);
+
+  // Checking the IK output of every point against the limits of each axis of
+  // the robot. Unreachable points have NaN joint values and are rejected too.
+  NeuroKinematicsf::ArrayXb accepted;
+  NeuroKinematicsf_.CheckJointLimits(IK_batch, ik_joint_limits_, accepted);
+
+  // Sizing the sub-workspace matrix once for all the accepted points
+  const int no_of_accepted_points = accepted.count();
+  sub_workspace_rcm_point_set.resize(3, no_of_accepted_points);
+  treatment_to_tp_dist.resize(no_of_accepted_points);
+
+  /* Loop that goes through each point in the Validated PC and stores the ones
+  with a valid IK output*/
+  for (int i = 0; i < no_cols_validated_point_set; i++)
+  {
+    if (!accepted(i))
     {
       continue;
     }
-    // This statement will increase the size of the Sub-workspace matrix
-    // by one to store the new point
-    if (counter > 0)
-    {
-      sub_workspace_rcm_point_set.conservativeResize(
-        3, sub_workspace_rcm_point_set.cols() + 1);
-      treatment_to_tp_dist.conservativeResize(treatment_to_tp_dist.size() + 1);
-    }
 
     // Storing the IK validated point in the sub-workspace matrix
-    sub_workspace_rcm_point_set(0, counter) = tp_in_robot_coordinate(0);
-    sub_workspace_rcm_point_set(1, counter) = tp_in_robot_coordinate(1);
-    sub_workspace_rcm_point_set(2, counter) = tp_in_robot_coordinate(2);
+    sub_workspace_rcm_point_set.col(counter) = validated_point_set.col(i);
 
     // Storing the distance from treatment to each IK validated point
     // If the target point is not yet reached by the treatment
-    if (IK_output.ProbeInsertion <= Probe_insert_max &&
-        IK_output.ProbeInsertion >= 0.)
+    if (IK_batch.ProbeInsertion(i) <= Probe_insert_max &&
+        IK_batch.ProbeInsertion(i) >= 0.)
     {
-      treatment_to_tp_dist(counter) = IK_output.ProbeInsertion;
+      treatment_to_tp_dist(counter) = IK_batch.ProbeInsertion(i);
     }
     // If the target point is reached by the treatment
     else
@@ -1504,10 +877,7 @@ int WorkspaceVisualization::GetPointCloudInverseKinematics(
     counter++;
   }
 
-  if (sub_workspace_rcm_point_set.cols() == 1 &&
-      sub_workspace_rcm_point_set(0, 0) == 0. &&
-      sub_workspace_rcm_point_set(1, 0) == 0. &&
-      sub_workspace_rcm_point_set(2, 0) == 0.)
+  if (no_of_accepted_points == 0)
   {
     // std::cerr << "\nThe entry point is NOT reachable! Please select "
     //              "another "
@@ -1516,7 +886,7 @@ int WorkspaceVisualization::GetPointCloudInverseKinematics(
     return WS_NOT_REACHABLE;
   };
   // PointSetUtilities data_w(sub_workspace_rcm_point_set);
-  // data_w.saveToXyz("IK_ckecked.xyz");
+  // data_w.saveToPoints("IK_ckecked.points");
   return WS_SAFE;
 }
 
@@ -1554,7 +924,7 @@ Eigen::Matrix3Xf WorkspaceVisualization::GenerateFinalSubworkspacePointset(
   3) subtract 2 from 1
   4) subtract max probe insertion value from 3 */
 
-  for (i = 0; i < no_cols; i++)
+  for (int i = 0; i < no_cols; i++)
   {
     if (treatment_to_tp_dist(i) > 0)
     {
@@ -1593,7 +963,7 @@ Eigen::Matrix3Xf WorkspaceVisualization::GenerateFinalSubworkspacePointset(
   intersection with the sphere*/
   double a{0}, b{0}, c{0}, t1{0}, t2{0}, x{0}, y{0}, z{0};
 
-  for (i = 0; i < no_cols; i++)
+  for (int i = 0; i < no_cols; i++)
   {
     rcm_point << validated_inverse_kinematic_rcm_pointset(0, i),
       validated_inverse_kinematic_rcm_pointset(1, i),
@@ -1639,7 +1009,7 @@ Eigen::Matrix3Xf WorkspaceVisualization::GenerateFinalSubworkspacePointset(
     // increments for z
     z = abs(coordinate_of_last_point(2) - ep_in_robot_coordinate(2)) / division;
 
-    for (j = 1; j <= division; j++)
+    for (int j = 1; j <= division; j++)
     {
       if (ep_in_robot_coordinate(0) < coordinate_of_last_point(0))
       {
@@ -1674,32 +1044,19 @@ Eigen::Matrix3Xf WorkspaceVisualization::GenerateFinalSubworkspacePointset(
   float lowest_y = lowest_config.zFrameToTreatment(1, 3);
   std::cout << "Lowest y: " << lowest_y;
 
-  Eigen::Matrix3Xf final_point_set(3, 1);
-  counter = 0;
+  // At most every generated point and the entry point are kept
+  PointCloudBuilder final_point_set(total_subworkspace_pointset.cols() + 1);
   for (int i = 0; i < total_subworkspace_pointset.cols(); i++)
   {
     if (total_subworkspace_pointset(1, i) < lowest_y)
     {
       continue;
     }
-    if (counter > 0)
-    {
-      final_point_set.conservativeResize(3, counter + 1);
-    }
-    for (int j = 0; j < 3; j++)
-    {
-
-      final_point_set(j, counter) = total_subworkspace_pointset(j, i);
-    }
-    counter++;
+    final_point_set.append(total_subworkspace_pointset.col(i));
   }
   // Adding entry point to the workspace
-  final_point_set.conservativeResize(3, final_point_set.cols() + 1);
-  for (int i = 0; i < 3; i++)
-  {
-    final_point_set(i, final_point_set.cols() - 1) = ep_in_robot_coordinate(i);
-  }
-  return final_point_set;
+  final_point_set.append(ep_in_robot_coordinate.cast< float >());
+  return final_point_set.release();
 }
 
 /*Method which applies the transform to the given entry point defined in the
@@ -1725,53 +1082,3 @@ void WorkspaceVisualization::CalculateTransform(
     ep_in_robot_coordinate(t) = entry_point_robot(t);
   }
 }
-
-/* Method takes a 4x4 transformation matrix comrised of [R P;0001], and
-extracts the position vector P, and appends it in a 3xN Eigen matrix.*/
-void WorkspaceVisualization::StorePointToEigenMatrix(
-  Eigen::Matrix3Xf& point_set, Eigen::Matrix4d transformation_matrix)
-{
-  int no_of_columns = point_set.cols();
-  // The case where the point set is empty
-  if (no_of_columns == 1 && point_set(0, 0) == 0. && point_set(1, 0) == 0. &&
-      point_set(2, 0) == 0.)
-  {
-    for (int i = 0; i < 3; i++)
-    {
-      point_set(i, 0) = transformation_matrix(i, 3);
-    }
-  }
-  // The case where the point set has at least one point in it
-  else
-  {
-    point_set.conservativeResize(3, no_of_columns + 1);
-    for (int i = 0; i < 3; i++)
-    {
-      point_set(i, no_of_columns) = transformation_matrix(i, 3);
-    }
-  }
-}
-
-void WorkspaceVisualization::StorePointToEigenMatrix(
-  Eigen::Matrix3Xf& point_set, double x, double y, double z)
-{
-  int no_of_columns = point_set.cols();
-  // The case for the first column
-  if (no_of_columns == 1 && point_set(0, 0) == 0. && point_set(1, 0) == 0. &&
-      point_set(2, 0) == 0.)
-  {
-    point_set(0, 0) = x;
-    point_set(1, 0) = y;
-    point_set(2, 0) = z;
-  }
-  // The case for all columns other than the first column
-  else
-  {
-    point_set.conservativeResize(3, no_of_columns + 1);
-    {
-      point_set(0, no_of_columns) = x;
-      point_set(1, no_of_columns) = y;
-      point_set(2, no_of_columns) = z;
-    }
-  }
-}
\ No newline at end of file
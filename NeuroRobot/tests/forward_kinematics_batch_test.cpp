@@ -0,0 +1,88 @@
+#include <NeuroKinematics/NeuroKinematics.hpp>
+#include <cstdlib>
+#include <iostream>
+
+// Compares the fused and batched FK against the scalar FK methods over a grid
+// of joint values spanning the robot's range of motion.
+int main(int argc, char** argv)
+{
+  double _cannulaToTreatment{0.0};
+  double _treatmentToTip{0.0};
+  double _robotToEntry{5.0};
+  double _robotToTreatmentAtHome{41.0};
+  Probe  probe_init = {_cannulaToTreatment, _treatmentToTip, _robotToEntry,
+                      _robotToTreatmentAtHome};
+  NeuroKinematics NeuroKinematics_(&probe_init);
+  // The batched FK runs in single precision
+  NeuroKinematicsf NeuroKinematicsf_(NeuroKinematics_);
+
+  const int         no_of_samples = 4096;
+  Neuro_joint_batch joints;
+  joints.resize(no_of_samples);
+  std::srand(42);
+  for (int i = 0; i < no_of_samples; i++)
+  {
+    double r[7];
+    for (int j = 0; j < 7; j++)
+    {
+      r[j] = std::rand() / ( double ) RAND_MAX;
+    }
+    joints.AxialHeadTranslation(i) = -145.0 + 145.0 * r[0];
+    joints.AxialFeetTranslation(i) = joints.AxialHeadTranslation(i) - 3.0 +
+                                     68.0 * r[1];
+    joints.LateralTranslation(i)   = -98.0 + 49.0 * r[2];
+    joints.ProbeInsertion(i)       = 40.0 * r[3];
+    joints.ProbeRotation(i)        = 6.28 * r[4];
+    joints.PitchRotation(i)        = (-37.0 + 63.0 * r[5]) * M_PI / 180;
+    joints.YawRotation(i)          = (-88.0 + 88.0 * r[6]) * M_PI / 180;
+  }
+
+  Eigen::Matrix3Xf rcm_positions(3, no_of_samples);
+  Eigen::Matrix3Xf entry_point_positions(3, no_of_samples);
+  Eigen::Matrix3Xf treatment_positions(3, no_of_samples);
+  NeuroKinematicsf_.ForwardKinematicsFramesBatch(
+    joints, &rcm_positions, &entry_point_positions, &treatment_positions);
+
+  double max_error = 0.0;
+  for (int i = 0; i < no_of_samples; i++)
+  {
+    Neuro_FK_outputs FK = NeuroKinematics_.ForwardKinematics(
+      joints.AxialHeadTranslation(i), joints.AxialFeetTranslation(i),
+      joints.LateralTranslation(i), joints.ProbeInsertion(i),
+      joints.ProbeRotation(i), joints.PitchRotation(i), joints.YawRotation(i));
+    Neuro_FK_outputs EP = NeuroKinematics_.ForwardKinematics_EntryPoint(
+      joints.AxialHeadTranslation(i), joints.AxialFeetTranslation(i),
+      joints.LateralTranslation(i), joints.ProbeInsertion(i),
+      joints.ProbeRotation(i), joints.PitchRotation(i), joints.YawRotation(i));
+    Neuro_FK_outputs RCM = NeuroKinematics_.GetRcm(
+      joints.AxialHeadTranslation(i), joints.AxialFeetTranslation(i),
+      joints.LateralTranslation(i), joints.ProbeInsertion(i),
+      joints.ProbeRotation(i), joints.PitchRotation(i), joints.YawRotation(i));
+    Neuro_FK_frames_outputs frames = NeuroKinematics_.ForwardKinematicsFrames(
+      joints.AxialHeadTranslation(i), joints.AxialFeetTranslation(i),
+      joints.LateralTranslation(i), joints.ProbeInsertion(i),
+      joints.ProbeRotation(i), joints.PitchRotation(i), joints.YawRotation(i));
+
+    // Fused frames must match the individual FK methods
+    max_error = std::max(
+      max_error, (frames.zFrameToTreatment - FK.zFrameToTreatment).norm());
+    max_error = std::max(
+      max_error, (frames.zFrameToEntryPoint - EP.zFrameToTreatment).norm());
+    max_error =
+      std::max(max_error, (frames.zFrameToRCM - RCM.zFrameToTreatment).norm());
+
+    // Batched positions must match the translation columns
+    Eigen::Vector3d error = FK.zFrameToTreatment.block< 3, 1 >(0, 3) -
+                            treatment_positions.col(i).cast< double >();
+    max_error = std::max(max_error, error.cwiseAbs().maxCoeff());
+    error = EP.zFrameToTreatment.block< 3, 1 >(0, 3) -
+            entry_point_positions.col(i).cast< double >();
+    max_error = std::max(max_error, error.cwiseAbs().maxCoeff());
+    error = RCM.zFrameToTreatment.block< 3, 1 >(0, 3) -
+            rcm_positions.col(i).cast< double >();
+    max_error = std::max(max_error, error.cwiseAbs().maxCoeff());
+  }
+
+  std::cout << "Max batch FK error (mm): " << max_error << std::endl;
+  return (max_error < 1e-3) ? 0 : 1;
+}
@@ -48,7 +48,7 @@ int main(int argc, char** argv)
   int              status =
     WorkspaceVisualization_.GetSubWorkspace(ep_in_robot_, final_workspace);
   PointSetUtilities data_writer4(final_workspace);
-  data_writer4.saveToXyz("final_workspace.xyz");
+  data_writer4.saveToPoints("final_workspace.points");
   vtkSmartPointer< vtkPoints > vpointSet = data_writer4.getVTKPointSet();
   return 0;
 }
\ No newline at end of file
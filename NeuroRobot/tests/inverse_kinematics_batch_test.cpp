@@ -0,0 +1,85 @@
+#include <NeuroKinematics/NeuroKinematics.hpp>
+#include <cstdlib>
+#include <iostream>
+
+// Compares the batched IK against the scalar IK for a single entry point and
+// RCM target points spread over the robot's range of motion.
+int main(int argc, char** argv)
+{
+  double _cannulaToTreatment{0.0};
+  double _treatmentToTip{0.0};
+  double _robotToEntry{5.0};
+  double _robotToTreatmentAtHome{41.0};
+  Probe  probe_init = {_cannulaToTreatment, _treatmentToTip, _robotToEntry,
+                      _robotToTreatmentAtHome};
+  NeuroKinematics NeuroKinematics_(&probe_init);
+  // The batched IK runs in single precision
+  NeuroKinematicsf NeuroKinematicsf_(NeuroKinematics_);
+
+  // Entry point of a configuration in the middle of the range of motion
+  Eigen::Vector4d entry_point =
+    NeuroKinematics_
+      .ForwardKinematics_EntryPoint(-72.0, -40.0, -73.0, 0.0, 0.0,
+                                    -5.0 * M_PI / 180, -44.0 * M_PI / 180)
+      .zFrameToTreatment.col(3);
+
+  const int        no_of_samples = 4096;
+  Eigen::Matrix3Xf target_points(3, no_of_samples);
+  std::srand(42);
+  for (int i = 0; i < no_of_samples; i++)
+  {
+    double r[3];
+    for (int j = 0; j < 3; j++)
+    {
+      r[j] = std::rand() / ( double ) RAND_MAX;
+    }
+    double AxialHeadTranslation = -145.0 + 145.0 * r[0];
+    double AxialFeetTranslation = AxialHeadTranslation - 3.0 + 68.0 * r[1];
+    double LateralTranslation   = -98.0 + 49.0 * r[2];
+    target_points.col(i) =
+      NeuroKinematics_
+        .GetRcm(AxialHeadTranslation, AxialFeetTranslation, LateralTranslation,
+                0.0, 0.0, 0.0, 0.0)
+        .zFrameToTreatment.block< 3, 1 >(0, 3)
+        .cast< float >();
+  }
+
+  Neuro_joint_batch joints;
+  NeuroKinematicsf_.InverseKinematicsBatch(entry_point.cast< float >(),
+                                           target_points, joints);
+
+  double max_error = 0.0;
+  int    no_of_nan_mismatches = 0;
+  for (int i = 0; i < no_of_samples; i++)
+  {
+    Eigen::Vector4d target_point(target_points(0, i), target_points(1, i),
+                                 target_points(2, i), 1);
+    Neuro_IK_outputs IK =
+      NeuroKinematics_.InverseKinematics(entry_point, target_point);
+
+    double expected[7] = {IK.AxialHeadTranslation, IK.AxialFeetTranslation,
+                          IK.LateralTranslation,   IK.ProbeInsertion,
+                          IK.ProbeRotation,        IK.PitchRotation,
+                          IK.YawRotation};
+    double actual[7]   = {
+      joints.AxialHeadTranslation(i), joints.AxialFeetTranslation(i),
+      joints.LateralTranslation(i),   joints.ProbeInsertion(i),
+      joints.ProbeRotation(i),        joints.PitchRotation(i),
+      joints.YawRotation(i)};
+    for (int j = 0; j < 7; j++)
+    {
+      // Targets that cannot be reached give NaN in both implementations
+      if (std::isnan(expected[j]) || std::isnan(actual[j]))
+      {
+        no_of_nan_mismatches +=
+          std::isnan(expected[j]) != std::isnan(actual[j]);
+        continue;
+      }
+      max_error = std::max(max_error, std::abs(expected[j] - actual[j]));
+    }
+  }
+
+  std::cout << "Max batch IK error: " << max_error << std::endl;
+  std::cout << "NaN mismatches: " << no_of_nan_mismatches << std::endl;
+  return (max_error < 1e-3 && no_of_nan_mismatches == 0) ? 0 : 1;
+}
@@ -0,0 +1,144 @@
+#include <NeuroKinematics/NeuroKinematics.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+
+// Compares the analytic Jacobians against central differences of the FK and
+// the batched Jacobians against the scalar ones over joint values spanning the
+// robot's range of motion.
+
+// Linear and angular velocity of a frame from the poses before and after a
+// joint step of 2 * h
+static Eigen::Matrix< double, 6, 1 >
+  FiniteDifference(const Eigen::Matrix4d& before, const Eigen::Matrix4d& after,
+                   const Eigen::Matrix4d& pose, double h)
+{
+  Eigen::Matrix< double, 6, 1 > twist;
+  twist.head< 3 >() =
+    (after.block< 3, 1 >(0, 3) - before.block< 3, 1 >(0, 3)) / (2 * h);
+  Eigen::Matrix3d skew = (after.block< 3, 3 >(0, 0) -
+                          before.block< 3, 3 >(0, 0)) /
+                         (2 * h) * pose.block< 3, 3 >(0, 0).transpose();
+  twist.tail< 3 >() << skew(2, 1), skew(0, 2), skew(1, 0);
+  return twist;
+}
+
+int main(int argc, char** argv)
+{
+  double _cannulaToTreatment{0.0};
+  double _treatmentToTip{0.0};
+  double _robotToEntry{5.0};
+  double _robotToTreatmentAtHome{41.0};
+  Probe  probe_init = {_cannulaToTreatment, _treatmentToTip, _robotToEntry,
+                      _robotToTreatmentAtHome};
+  NeuroKinematics NeuroKinematics_(&probe_init);
+  // The batched Jacobians run in single precision
+  NeuroKinematicsf NeuroKinematicsf_(NeuroKinematics_);
+
+  const int         no_of_samples = 1024;
+  const double      h             = 1e-6;
+  Neuro_joint_batch joints;
+  joints.resize(no_of_samples);
+  std::srand(42);
+  for (int i = 0; i < no_of_samples; i++)
+  {
+    double r[7];
+    for (int j = 0; j < 7; j++)
+    {
+      r[j] = std::rand() / ( double ) RAND_MAX;
+    }
+    joints.AxialHeadTranslation(i) = -145.0 + 145.0 * r[0];
+    joints.AxialFeetTranslation(i) = joints.AxialHeadTranslation(i) - 3.0 +
+                                     68.0 * r[1];
+    joints.LateralTranslation(i)   = -98.0 + 49.0 * r[2];
+    joints.ProbeInsertion(i)       = 40.0 * r[3];
+    joints.ProbeRotation(i)        = 6.28 * r[4];
+    joints.PitchRotation(i)        = (-37.0 + 63.0 * r[5]) * M_PI / 180;
+    joints.YawRotation(i)          = (-88.0 + 88.0 * r[6]) * M_PI / 180;
+  }
+
+  NeuroKinematicsf::JacobianBatch rcm_jacobians, entry_point_jacobians,
+    treatment_jacobians;
+  NeuroKinematicsf_.JacobiansBatch(joints, &rcm_jacobians,
+                                   &entry_point_jacobians,
+                                   &treatment_jacobians);
+
+  double max_fd_error    = 0.0;
+  double max_batch_error = 0.0;
+  for (int i = 0; i < no_of_samples; i++)
+  {
+    double q[7] = {joints.AxialHeadTranslation(i),
+                   joints.AxialFeetTranslation(i),
+                   joints.LateralTranslation(i),
+                   joints.ProbeInsertion(i),
+                   joints.ProbeRotation(i),
+                   joints.PitchRotation(i),
+                   joints.YawRotation(i)};
+    Neuro_Jacobian_outputs J =
+      NeuroKinematics_.Jacobians(q[0], q[1], q[2], q[3], q[4], q[5], q[6]);
+    Neuro_FK_frames_outputs FK = NeuroKinematics_.ForwardKinematicsFrames(
+      q[0], q[1], q[2], q[3], q[4], q[5], q[6]);
+
+    for (int j = 0; j < 7; j++)
+    {
+      double q_before[7], q_after[7];
+      std::copy(q, q + 7, q_before);
+      std::copy(q, q + 7, q_after);
+      q_before[j] -= h;
+      q_after[j] += h;
+      Neuro_FK_frames_outputs before = NeuroKinematics_.ForwardKinematicsFrames(
+        q_before[0], q_before[1], q_before[2], q_before[3], q_before[4],
+        q_before[5], q_before[6]);
+      Neuro_FK_frames_outputs after = NeuroKinematics_.ForwardKinematicsFrames(
+        q_after[0], q_after[1], q_after[2], q_after[3], q_after[4],
+        q_after[5], q_after[6]);
+
+      max_fd_error = std::max(
+        max_fd_error,
+        (FiniteDifference(before.zFrameToRCM, after.zFrameToRCM,
+                          FK.zFrameToRCM, h) -
+         J.zFrameToRCM.col(j))
+          .cwiseAbs()
+          .maxCoeff());
+      max_fd_error = std::max(
+        max_fd_error,
+        (FiniteDifference(before.zFrameToEntryPoint, after.zFrameToEntryPoint,
+                          FK.zFrameToEntryPoint, h) -
+         J.zFrameToEntryPoint.col(j))
+          .cwiseAbs()
+          .maxCoeff());
+      max_fd_error = std::max(
+        max_fd_error,
+        (FiniteDifference(before.zFrameToTreatment, after.zFrameToTreatment,
+                          FK.zFrameToTreatment, h) -
+         J.zFrameToTreatment.col(j))
+          .cwiseAbs()
+          .maxCoeff());
+    }
+
+    typedef Eigen::Map< NeuroKinematicsf::Jacobian > JacobianMap;
+    max_batch_error = std::max(
+      max_batch_error,
+      (JacobianMap(rcm_jacobians.col(i).data()).cast< double >() -
+       J.zFrameToRCM)
+        .cwiseAbs()
+        .maxCoeff());
+    max_batch_error = std::max(
+      max_batch_error,
+      (JacobianMap(entry_point_jacobians.col(i).data()).cast< double >() -
+       J.zFrameToEntryPoint)
+        .cwiseAbs()
+        .maxCoeff());
+    max_batch_error = std::max(
+      max_batch_error,
+      (JacobianMap(treatment_jacobians.col(i).data()).cast< double >() -
+       J.zFrameToTreatment)
+        .cwiseAbs()
+        .maxCoeff());
+  }
+
+  std::cout << "Max Jacobian error against finite differences: "
+            << max_fd_error << std::endl;
+  std::cout << "Max batch Jacobian error: " << max_batch_error << std::endl;
+  return (max_fd_error < 1e-4 && max_batch_error < 1e-3) ? 0 : 1;
+}
@@ -0,0 +1,38 @@
+#include <NeuroKinematics/NeuroKinematics.hpp>
+#include <iostream>
+
+// Checks the joint limit mask and the violation bits for a few hand picked
+// configurations, including an unreachable one with NaN joint values.
+int main(int argc, char** argv)
+{
+  Probe              probe_init = {0.0, 0.0, 5.0, 41.0};
+  NeuroKinematicsf   NeuroKinematics_(&probe_init);
+  Neuro_joint_limits limits;
+
+  Neuro_joint_batch joints;
+  joints.resize(4);
+  joints.AxialHeadTranslation << -72, -72, 10, NAN;
+  joints.AxialFeetTranslation << -40, -40, -40, NAN;
+  joints.LateralTranslation << -73, -73, -73, -73;
+  joints.ProbeInsertion << 20, 50, 20, 20;
+  joints.ProbeRotation << 0, 0, 0, 0;
+  joints.PitchRotation << -0.1, -0.1, -0.1, -0.1;
+  joints.YawRotation << -0.5, 0.5, -0.5, -0.5;
+
+  NeuroKinematicsf::ArrayXb accepted;
+  Eigen::ArrayXi            violations;
+  NeuroKinematics_.CheckJointLimits(joints, limits, accepted, &violations);
+
+  // Separation of the third configuration is 193 mm, beyond the 146 mm limit
+  Eigen::ArrayXi expected(4);
+  expected << NEURO_LIMIT_NONE, NEURO_LIMIT_PROBE_INSERTION | NEURO_LIMIT_YAW,
+    NEURO_LIMIT_AXIAL_SEPARATION | NEURO_LIMIT_AXIAL_HEAD,
+    NEURO_LIMIT_AXIAL_SEPARATION | NEURO_LIMIT_AXIAL_HEAD |
+      NEURO_LIMIT_AXIAL_FEET;
+
+  std::cout << "Violations: " << violations.transpose() << std::endl;
+  std::cout << "Accepted: " << accepted.transpose() << std::endl;
+  bool passed = (violations == expected).all() && accepted(0) &&
+                !accepted.tail(3).any();
+  return passed ? 0 : 1;
+}
@@ -0,0 +1,154 @@
+#include <WorkspaceVisualization/JointSpaceSampler.hpp>
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+// Largest difference (mm) between the points of the batched float FK and those
+// of the scalar double FK, or the same sample evaluated in another batch
+static const float kTolerance = 1e-3f;
+
+static bool IsClose(const Eigen::Vector3f& a, const Eigen::Vector3f& b)
+{
+  return (a - b).cwiseAbs().maxCoeff() <= kTolerance;
+}
+
+// Checks that the samples of a patch are the joint values of the nested loops
+// it describes, that the evaluated point set matches the scalar FK, and that
+// the adaptive point set is a subset of it.
+int main(int argc, char** argv)
+{
+  double _cannulaToTreatment{0.0};
+  double _treatmentToTip{0.0};
+  double _robotToEntry{5.0};
+  double _robotToTreatmentAtHome{41.0};
+  Probe  probe_init = {_cannulaToTreatment, _treatmentToTip, _robotToEntry,
+                      _robotToTreatmentAtHome};
+  NeuroKinematics NeuroKinematics_(&probe_init);
+
+  const double axial_step   = -145. / 65;
+  const double lateral_step = -49. / 15;
+  const double pitch_step   = -26. * 3.141 / 180 / 10;
+
+  // Reference nested loops, the axial head and feet move together
+  std::vector< JointConfiguration > expected;
+  JointConfiguration                joints{};
+  joints.AxialHeadTranslation = axial_step;
+  joints.AxialFeetTranslation = 68. + axial_step;
+  for (double i = axial_step; i >= -145.; i += axial_step)
+  {
+    for (double k = -49.; k >= -98.; k += lateral_step)
+    {
+      joints.LateralTranslation = k;
+      for (double j = 0; j >= -26. * 3.141 / 180; j += pitch_step)
+      {
+        joints.PitchRotation = j;
+        expected.push_back(joints);
+      }
+    }
+    joints.AxialHeadTranslation += axial_step;
+    joints.AxialFeetTranslation += axial_step;
+  }
+
+  JointSpaceSampler       sampler;
+  JointSpaceSampler::Axis axial{}, lateral{}, pitch{};
+  axial.step.AxialHeadTranslation = axial_step;
+  axial.step.AxialFeetTranslation = axial_step;
+  axial.count = JointSpaceSampler::GetStepCount(axial_step, axial_step, -145.);
+  lateral.step.LateralTranslation = lateral_step;
+  lateral.count = JointSpaceSampler::GetStepCount(-49., lateral_step, -98.);
+  pitch.step.PitchRotation = pitch_step;
+  pitch.count =
+    JointSpaceSampler::GetStepCount(0., pitch_step, -26. * 3.141 / 180);
+
+  JointConfiguration base{};
+  base.AxialHeadTranslation = axial_step;
+  base.AxialFeetTranslation = 68. + axial_step;
+  base.LateralTranslation   = -49.;
+  // An empty patch between two patches does not shift the samples
+  sampler.AddPatch(base, {axial, lateral, pitch});
+  lateral.count = 0;
+  sampler.AddPatch(base, {axial, lateral, pitch});
+  sampler.AddPatch(base);
+
+  if (sampler.GetNumberOfSamples() != ( long ) expected.size() + 1)
+  {
+    std::cerr << "Expected " << expected.size() + 1 << " samples, got "
+              << sampler.GetNumberOfSamples() << std::endl;
+    return 1;
+  }
+  expected.push_back(base);
+
+  // Samples are requested in uneven ranges, like the chunks of a parallel loop
+  std::vector< JointConfiguration > samples(expected.size());
+  for (long begin = 0; begin < ( long ) samples.size(); begin += 333)
+  {
+    long end = std::min(begin + 333, ( long ) samples.size());
+    sampler.GetSamples(begin, end, samples.data() + begin);
+  }
+  if (std::memcmp(samples.data(), expected.data(),
+                  expected.size() * sizeof(JointConfiguration)) != 0)
+  {
+    std::cerr << "Samples differ from the nested loops" << std::endl;
+    return 1;
+  }
+
+  Eigen::Matrix3Xf points =
+    sampler.Evaluate(NeuroKinematics_, NEURO_FK_TREATMENT);
+  for (size_t s = 0; s < expected.size(); s++)
+  {
+    const JointConfiguration& q  = expected[s];
+    Neuro_FK_outputs          FK = NeuroKinematics_.ForwardKinematics(
+      q.AxialHeadTranslation, q.AxialFeetTranslation, q.LateralTranslation,
+      q.ProbeInsertion, q.ProbeRotation, q.PitchRotation, q.YawRotation);
+    Eigen::Vector3f point =
+      FK.zFrameToTreatment.block< 3, 1 >(0, 3).cast< float >();
+    if (!IsClose(points.col(s), point))
+    {
+      std::cerr << "Point " << s << " differs from the FK" << std::endl;
+      return 1;
+    }
+  }
+
+  // Refining every cell down to single steps yields every sample in order
+  Eigen::Matrix3Xf refined =
+    sampler.EvaluateAdaptive(NeuroKinematics_, NEURO_FK_TREATMENT, 0., 1e-6);
+  bool is_refined = refined.cols() == points.cols();
+  for (Eigen::Index s = 0; is_refined && s < points.cols(); s++)
+  {
+    is_refined = IsClose(refined.col(s), points.col(s));
+  }
+  if (!is_refined)
+  {
+    std::cerr << "Fully refined samples differ from the uniform samples"
+              << std::endl;
+    return 1;
+  }
+
+  // A coarse tolerance keeps fewer samples, each of them a uniform sample
+  Eigen::Matrix3Xf adaptive =
+    sampler.EvaluateAdaptive(NeuroKinematics_, NEURO_FK_TREATMENT, 1., 0.);
+  if (adaptive.cols() == 0 || adaptive.cols() >= points.cols())
+  {
+    std::cerr << "Expected fewer adaptive samples than " << points.cols()
+              << ", got " << adaptive.cols() << std::endl;
+    return 1;
+  }
+  for (Eigen::Index a = 0, s = 0; a < adaptive.cols(); a++, s++)
+  {
+    while (s < points.cols() && !IsClose(points.col(s), adaptive.col(a)))
+    {
+      s++;
+    }
+    if (s == points.cols())
+    {
+      std::cerr << "Adaptive point " << a << " is not a uniform sample"
+                << std::endl;
+      return 1;
+    }
+  }
+
+  std::cout << expected.size() << " samples match, " << adaptive.cols()
+            << " adaptive samples" << std::endl;
+  return 0;
+}
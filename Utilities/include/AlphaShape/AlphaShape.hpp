@@ -0,0 +1,55 @@
+/**
+ * @file AlphaShape.hpp
+ * @brief Surface reconstruction of a point set with an alpha shape.
+ *
+ * The points are first thinned out to a Poisson disk subset of about a given
+ * number of samples, then the Delaunay tetrahedra and triangles of the subset
+ * whose circumsphere is smaller than alpha are kept and the boundary of their
+ * union is the surface. Alpha is given as a percentage of the diagonal of the
+ * bounding box of the subset, so the surface does not depend on the scale of
+ * the points.
+ *
+ */
+
+#ifndef ALPHASHAPE_HPP
+#define ALPHASHAPE_HPP
+
+#include <eigen3/Eigen/Dense>
+#include <vtkPolyData.h>
+#include <vtkSmartPointer.h>
+
+class AlphaShape
+{
+private:
+  // Alpha in percent of the diagonal of the bounding box of the samples
+  double AlphaPercentage;
+  // Number of samples the point set is thinned out to, 0 keeps all the points
+  int NumberOfSamples;
+
+public:
+  // The defaults are those of the meshlab script the workspaces were meshed
+  // with before
+  AlphaShape(double alphaPercentage = 5., int numberOfSamples = 1000);
+
+  // Getters
+  double getAlphaPercentage() const { return AlphaPercentage; }
+  int    getNumberOfSamples() const { return NumberOfSamples; }
+
+  // Methods
+  // Subset of the finite points no two of which are closer than radius (mm),
+  // picked in a fixed pseudo-random order
+  static Eigen::Matrix3Xf
+    poissonDiskSample(const Eigen::Ref< const Eigen::Matrix3Xf >& pointSet,
+                      double                                      radius);
+  // Poisson disk subset of about count of the finite points, all of them if
+  // count is 0
+  static Eigen::Matrix3Xf
+    poissonDiskSubset(const Eigen::Ref< const Eigen::Matrix3Xf >& pointSet,
+                      int                                         count);
+  // Triangulated boundary of the alpha shape, empty if there are fewer than
+  // four points
+  vtkSmartPointer< vtkPolyData >
+    reconstruct(const Eigen::Ref< const Eigen::Matrix3Xf >& pointSet) const;
+};
+
+#endif  // ALPHASHAPE_HPP
@@ -0,0 +1,66 @@
+/**
+ * @file OccupancyGrid.hpp
+ * @brief Binary voxel occupancy of a point set in a reference image grid.
+ *
+ * The grid is the block of voxels of a reference image which covers the
+ * points, so it can be handed over as a labelmap with the geometry of the
+ * image. The voxels containing a point are occupied. Since the points only
+ * sample the surface of a workspace, fill() then closes the gaps between them
+ * and occupies the voxels they enclose. Whether a voxel is enclosed depends on
+ * the whole surface, so the grid only gets cropped to the extent of the
+ * reference image once it is filled.
+ *
+ */
+
+#ifndef OCCUPANCYGRID_HPP
+#define OCCUPANCYGRID_HPP
+
+#include <eigen3/Eigen/Dense>
+#include <vector>
+
+class OccupancyGrid
+{
+private:
+  // Transform from the voxel indices of the reference grid to positions
+  Eigen::Matrix4d IJKToPosition;
+  // Reference indices of the first voxel and number of voxels along each axis
+  Eigen::Array3i Offset;
+  Eigen::Array3i Dimensions;
+  // 1 for the occupied voxels, the first index varies fastest
+  std::vector< unsigned char > Voxels;
+  // Reference extent the grid is cropped to by fill()
+  Eigen::Array3i Lower;
+  Eigen::Array3i Upper;
+
+  // Squared distance (mm^2) of every voxel to the nearest voxel of mask
+  std::vector< float >
+    squaredDistanceTo(const std::vector< unsigned char >& mask) const;
+  // Keeps the voxels of the grid inside [Lower, Upper]
+  void crop();
+
+public:
+  OccupancyGrid();
+  // Voxels of a reference grid which cover the points grown by margin (mm),
+  // plus an empty border of one voxel, whether they are inside the extent
+  // [lower, upper] or not. The points which are not finite are left out.
+  OccupancyGrid(const Eigen::Matrix4d& ijkToPosition,
+                const Eigen::Array3i& lower, const Eigen::Array3i& upper,
+                const Eigen::Ref< const Eigen::Matrix3Xf >& pointSet,
+                double                                      margin);
+
+  // Getters
+  const Eigen::Matrix4d& getIJKToPosition() const { return IJKToPosition; }
+  const Eigen::Array3i&  getOffset() const { return Offset; }
+  const Eigen::Array3i&  getDimensions() const { return Dimensions; }
+  const std::vector< unsigned char >& getVoxels() const { return Voxels; }
+  // Number of occupied voxels
+  long count() const;
+
+  // Methods
+  // Occupies the voxels enclosed by the occupied ones, after closing the gaps
+  // narrower than 2 * radius (mm) between them, then crops the grid to the
+  // reference extent. The margin of the grid should be at least radius.
+  void fill(double radius);
+};
+
+#endif  // OCCUPANCYGRID_HPP
@@ -0,0 +1,71 @@
+/**
+ * @file PointCloudBuilder.hpp
+ * @brief Append-only buffer used to generate point sets.
+ *
+ * Points are appended into a 3xN matrix whose capacity grows geometrically,
+ * and the number of stored points is tracked explicitly so a point at the
+ * origin is stored like any other. Once generated, the points are handed off
+ * to an Eigen::Matrix3Xf without copying them.
+ *
+ */
+
+#ifndef POINTCLOUDBUILDER_HPP
+#define POINTCLOUDBUILDER_HPP
+
+#include <eigen3/Eigen/Dense>
+
+class PointCloudBuilder
+{
+private:
+  // Storage of the points, its number of columns is the capacity
+  Eigen::Matrix3Xf PointSet;
+  // Number of points appended so far
+  Eigen::Index NumberOfPoints;
+
+  // Grows the capacity geometrically to hold at least minCapacity points
+  void grow(Eigen::Index minCapacity);
+
+public:
+  PointCloudBuilder(Eigen::Index capacity = 0);
+
+  // Makes room for at least capacity points, e.g. when the number of points
+  // is counted before they are generated
+  void reserve(Eigen::Index capacity);
+  // Removes all points and keeps the capacity
+  void clear();
+
+  // Getters
+  Eigen::Index size() const { return NumberOfPoints; }
+  Eigen::Index capacity() const { return PointSet.cols(); }
+  bool         empty() const { return NumberOfPoints == 0; }
+  const float* data() const { return PointSet.data(); }
+
+  // Methods
+  void append(float x, float y, float z)
+  {
+    if (NumberOfPoints == PointSet.cols())
+    {
+      grow(NumberOfPoints + 1);
+    }
+    PointSet(0, NumberOfPoints) = x;
+    PointSet(1, NumberOfPoints) = y;
+    PointSet(2, NumberOfPoints) = z;
+    NumberOfPoints++;
+  }
+  void append(const Eigen::Vector3f& point)
+  {
+    append(point(0), point(1), point(2));
+  }
+  // Appends the position vector P of a 4x4 transformation matrix [R P;0001]
+  void appendTranslation(const Eigen::Matrix4d& transformationMatrix)
+  {
+    append(transformationMatrix(0, 3), transformationMatrix(1, 3),
+           transformationMatrix(2, 3));
+  }
+
+  // Moves the points out as a 3xsize() matrix and leaves the builder empty.
+  // Unused capacity is released in place, the points are not copied.
+  Eigen::Matrix3Xf release();
+};
+
+#endif  // POINTCLOUDBUILDER_HPP
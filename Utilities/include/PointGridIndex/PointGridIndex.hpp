@@ -0,0 +1,67 @@
+/**
+ * @file PointGridIndex.hpp
+ * @brief Uniform grid over a point set for sphere queries.
+ *
+ * The bounding box of the points is split into cubic cells and the points are
+ * copied sorted by cell once, when the index is built, so the points of a
+ * cell are consecutive. A sphere query only visits the cells overlapping the
+ * sphere and returns the ranges of points of the cells entirely inside it,
+ * whose points are all inside, and of the cells crossing its surface, whose
+ * points still have to be tested by the caller.
+ *
+ */
+
+#ifndef POINTGRIDINDEX_HPP
+#define POINTGRIDINDEX_HPP
+
+#include <eigen3/Eigen/Dense>
+#include <utility>
+#include <vector>
+
+class PointGridIndex
+{
+public:
+  // Half open range [first, second) of columns of getPoints()
+  typedef std::pair< Eigen::Index, Eigen::Index > Range;
+
+private:
+  // Lowest corner of the grid and edge length of the cells
+  Eigen::Vector3d Origin;
+  double          CellSize;
+  // Number of cells along each axis
+  Eigen::Array3i Dimensions;
+  // The points of cell c are the columns CellStart[c] to CellStart[c + 1] - 1
+  std::vector< Eigen::Index > CellStart;
+  // Points sorted by cell, and their columns in the indexed point set
+  Eigen::Matrix3Xf            Points;
+  std::vector< Eigen::Index > PointIndices;
+
+  // Appends range to ranges, merging it with the last one if they touch
+  static void appendRange(std::vector< Range >& ranges, const Range& range);
+
+public:
+  PointGridIndex();
+  // Points which are not finite are left out of the index. The cell size is
+  // increased if needed to keep the number of cells around the number of
+  // points.
+  PointGridIndex(const Eigen::Matrix3Xf& pointSet, double cellSize);
+
+  // Getters
+  double                  getCellSize() const { return CellSize; }
+  Eigen::Array3i          getDimensions() const { return Dimensions; }
+  Eigen::Index            size() const { return Points.cols(); }
+  const Eigen::Matrix3Xf& getPoints() const { return Points; }
+  // Column in the indexed point set of column i of getPoints()
+  Eigen::Index getPointIndex(Eigen::Index i) const { return PointIndices[i]; }
+
+  // Methods
+  // Appends the ranges of points of the cells entirely inside the sphere to
+  // inside and those of the cells crossing its surface to crossing. Cells are
+  // only considered inside when they clear the surface by a margin, so points
+  // on the boundary always end up in crossing.
+  void querySphere(const Eigen::Vector3d& center, double radius,
+                   std::vector< Range >& inside,
+                   std::vector< Range >& crossing) const;
+};
+
+#endif  // POINTGRIDINDEX_HPP
@@ -12,29 +12,98 @@
 #define POINTSETUTILITIES_HPP
 
 #include <eigen3/Eigen/Dense>
+#include <memory>
 #include <vtkPoints.h>
+#include <vtkPolyData.h>
 #include <vtkSmartPointer.h>
 // QT Includes
 #include <QDir>
+#include <QFile>
+#include <QIODevice>
 #include <QString>
 
 class PointSetUtilities
 {
 private:
-  Eigen::Matrix3Xf EigenPointSet;
+  // Shared with the VTK point sets returned by getVTKPointSet, which keep it
+  // alive and write through to it. setEigenPointSet replaces it rather than
+  // modifying it, so the VTK point sets keep the previous one.
+  std::shared_ptr< Eigen::Matrix3Xf > EigenPointSet;
 
 public:
+  // The point set is moved in when it is passed as an rvalue
   PointSetUtilities(Eigen::Matrix3Xf pointSet);
 
   // Setters
   void setEigenPointSet(Eigen::Matrix3Xf pointSet);
 
   // Getters
-  Eigen::Matrix3Xf             getEigenPointSet();
-  vtkSmartPointer< vtkPoints > getVTKPointSet();
+  const Eigen::Matrix3Xf& getEigenPointSet() const;
+  // Points whose coordinate array wraps the Eigen point set without copying
+  // it, the point set stays alive as long as the array does. The points alias
+  // the point set: modifying them, e.g. with SetPoint or an in-place filter,
+  // modifies what getEigenPointSet returns, for this object, its copies and
+  // the other VTK point sets of the same point set. DeepCopy them first to
+  // modify them on their own.
+  vtkSmartPointer< vtkPoints > getVTKPointSet() const;
 
   // Methods
+  // Text file with a point and a null normal per line, for viewers such as
+  // meshlab
   void saveToXyz(const char* fileName);
+  // Binary file with a small header followed by the raw float32 coordinates,
+  // the format of the workspace dumps and caches. The file of a mesh adds a
+  // block of triangles, the point indices of their corners. Load returns false
+  // if the file is missing, truncated or not such a file.
+  bool        saveToPoints(const char* fileName);
+  static bool saveToPoints(const char*             fileName,
+                           const Eigen::Matrix3Xf& pointSet);
+  static bool saveToPoints(const char*             fileName,
+                           const Eigen::Matrix3Xf& pointSet,
+                           const Eigen::Matrix3Xi& triangles);
+  static bool loadFromPoints(const char* fileName, Eigen::Matrix3Xf& pointSet);
+  // The same format on an open device, from or to its current position
+  static bool writePoints(QIODevice& device, const Eigen::Matrix3Xf& pointSet);
+  static bool writeTriangles(QIODevice&              device,
+                             const Eigen::Matrix3Xi& triangles);
+  static bool readPoints(QIODevice& device, Eigen::Matrix3Xf& pointSet);
 };
 
-#endif  // POINTSETUTILITES_HPP
\ No newline at end of file
+// A .points file mapped in memory. The points, and the triangles of a mesh,
+// are used in place, so opening even a large file only costs the page faults
+// of the parts which are read. The mapping is private: its pages are copied
+// when written, the file itself is never modified.
+class MappedPointSet
+{
+private:
+  QFile        File;
+  uchar*       Data;
+  Eigen::Index NumberOfPoints;
+  // Offset of the first triangle, 0 if there is no triangle block
+  qint64       TrianglesOffset;
+  Eigen::Index NumberOfTriangles;
+
+public:
+  typedef Eigen::Map< const Eigen::Matrix3Xf > Points;
+  typedef Eigen::Map< const Eigen::Matrix3Xi > Triangles;
+
+  // Check isValid() for whether the file could be mapped
+  MappedPointSet(const QString& fileName);
+  MappedPointSet(const MappedPointSet&) = delete;
+  MappedPointSet& operator=(const MappedPointSet&) = delete;
+
+  // Getters
+  bool      isValid() const { return Data != NULL; }
+  Points    getPoints() const;
+  // No triangles unless the file is that of a mesh
+  Triangles getTriangles() const;
+
+  // Poly data whose point coordinates and triangle connectivity wrap the
+  // mapped file without copying it, NULL unless it holds a valid mesh. The
+  // arrays keep the mapping alive. The connectivity is copied with VTK 8,
+  // whose cell arrays interleave the size of each cell with its points.
+  static vtkSmartPointer< vtkPolyData >
+    getVTKMesh(const std::shared_ptr< const MappedPointSet >& mesh);
+};
+
+#endif  // POINTSETUTILITES_HPP
@@ -0,0 +1,66 @@
+/**
+ * @file ThreadPool.hpp
+ * @brief Pool of worker threads for data parallel loops.
+ *
+ * parallelFor splits a range of indices into chunks which the workers and the
+ * calling thread claim one at a time until the range is exhausted, so a thread
+ * that finishes early keeps taking work from the others. The chunk boundaries
+ * only depend on the range and the grain size, so results written per index
+ * do not depend on the number of threads or on scheduling.
+ *
+ */
+
+#ifndef THREADPOOL_HPP
+#define THREADPOOL_HPP
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool
+{
+public:
+  // Body called with the half open range [begin, end) of a chunk
+  typedef std::function< void(long begin, long end) > RangeFunction;
+
+  // The calling thread takes part in every loop, so numberOfThreads - 1
+  // workers are started. 0 uses one thread per hardware thread.
+  ThreadPool(unsigned int numberOfThreads = 0);
+  ~ThreadPool();
+
+  // Getters
+  unsigned int size() const { return Workers.size() + 1; }
+
+  // Methods
+
+  // Calls body on chunks of at most grainSize indices covering [0, count) and
+  // returns once all of them are done. The body must not throw. Loops started
+  // from inside a body run serially on the calling thread.
+  void parallelFor(long count, long grainSize, const RangeFunction& body);
+
+  // Pool shared by the whole process, started on first use. Its size is read
+  // from NEUROROBOT_NUM_THREADS and defaults to the hardware threads.
+  static ThreadPool& global();
+
+private:
+  struct Loop;
+
+  void workerMain();
+  static void runChunks(Loop& loop);
+
+  std::vector< std::thread > Workers;
+  // Serializes loops started concurrently from different threads
+  std::mutex LoopMutex;
+  // Guards the members below
+  std::mutex              Mutex;
+  std::condition_variable LoopStarted;
+  std::condition_variable LoopFinished;
+  Loop*                   CurrentLoop;
+  unsigned long           LoopGeneration;
+  unsigned int            ActiveWorkers;
+  bool                    Stopping;
+};
+
+#endif  // THREADPOOL_HPP
@@ -0,0 +1,72 @@
+/**
+ * @file WorkspaceCache.hpp
+ * @brief On-disk cache of generated workspace point sets and meshes.
+ *
+ * Entries are addressed by a key derived from a hash of everything the
+ * workspace depends on, so a stale entry is never returned, it is simply not
+ * found. Point sets are stored in the .points format of PointSetUtilities, a
+ * small header followed by the raw float32 coordinates, and meshes in the
+ * same format with their block of triangles. Both are mapped in memory when
+ * loaded instead of being read and parsed. Every entry is written to a
+ * temporary file first and then renamed, so an interrupted write does not
+ * leave a truncated entry behind.
+ *
+ */
+
+#ifndef WORKSPACECACHE_HPP
+#define WORKSPACECACHE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <eigen3/Eigen/Dense>
+#include <memory>
+#include <vtkPolyData.h>
+#include <vtkSmartPointer.h>
+// QT Includes
+#include <QString>
+
+class MappedPointSet;
+
+class WorkspaceCache
+{
+private:
+  QString Directory;
+
+  QString pointSetPath(const QString& key) const;
+  QString meshPath(const QString& key) const;
+
+public:
+  // An empty directory uses defaultDirectory()
+  WorkspaceCache(const QString& directory = QString());
+
+  // NEUROROBOT_WORKSPACE_CACHE_DIR if set, the user cache directory otherwise
+  static QString defaultDirectory();
+
+  // FNV-1a hash of size bytes, chained through seed to hash several values
+  static uint64_t hash(const void* data, size_t size,
+                       uint64_t seed = 14695981039346656037ULL);
+  // File name of the entry of a workspace given the hash of its parameters
+  static QString makeKey(const QString& name, uint64_t hash);
+
+  // Getters
+  QString getDirectory() const { return Directory; }
+
+  // Methods
+  // Whether there is a point set entry, without validating it
+  bool hasPointSet(const QString& key) const;
+  // The load methods return false or NULL if there is no valid entry
+  bool loadPointSet(const QString& key, Eigen::Matrix3Xf& pointSet) const;
+  bool savePointSet(const QString& key, const Eigen::Matrix3Xf& pointSet) const;
+  // The point set entry mapped in memory, its pages are only read when used
+  std::shared_ptr< const MappedPointSet >
+    mapPointSet(const QString& key) const;
+  // The mesh entry mapped in memory, see MappedPointSet::getVTKMesh
+  vtkSmartPointer< vtkPolyData > loadMesh(const QString& key) const;
+  // Only the points and triangles are stored, fails if the mesh has other
+  // cells
+  bool saveMesh(const QString& key, vtkPolyData* mesh) const;
+  // Removes all entries
+  bool clear() const;
+};
+
+#endif  // WORKSPACECACHE_HPP
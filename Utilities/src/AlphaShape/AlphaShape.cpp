@@ -0,0 +1,192 @@
+/**
+ * @file AlphaShape.cpp
+ * @brief Surface reconstruction of a point set with an alpha shape.
+ *
+ */
+
+#include "AlphaShape/AlphaShape.hpp"
+#include "PointSetUtilities/PointSetUtilities.hpp"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <vtkDataSetSurfaceFilter.h>
+#include <vtkDelaunay3D.h>
+
+// Number of times the Poisson disk radius is corrected to get close to the
+// requested number of samples, and how close is close enough
+static const int    kMaxRadiusCorrections = 8;
+static const double kSampleCountTolerance = 0.1;
+
+// Key of the hash cell (x, y, z), cells sharing a key only cost a few more
+// distance tests
+static long long CellKey(long long x, long long y, long long z)
+{
+  return (x * 73856093LL) ^ (y * 19349663LL) ^ (z * 83492791LL);
+}
+
+AlphaShape::AlphaShape(double alphaPercentage, int numberOfSamples)
+  : AlphaPercentage(alphaPercentage)
+  , NumberOfSamples(numberOfSamples)
+{
+}
+
+Eigen::Matrix3Xf AlphaShape::poissonDiskSample(
+  const Eigen::Ref< const Eigen::Matrix3Xf >& pointSet, double radius)
+{
+  std::vector< Eigen::Index > order;
+  order.reserve(pointSet.cols());
+  for (Eigen::Index i = 0; i < pointSet.cols(); i++)
+  {
+    if (pointSet.col(i).allFinite())
+    {
+      order.push_back(i);
+    }
+  }
+  if (radius <= 0. || order.empty())
+  {
+    Eigen::Matrix3Xf samples(3, order.size());
+    for (size_t i = 0; i < order.size(); i++)
+    {
+      samples.col(i) = pointSet.col(order[i]);
+    }
+    return samples;
+  }
+
+  // The workspaces are swept in order, visiting the points in a random order
+  // spreads the samples evenly
+  std::mt19937 generator(0);
+  std::shuffle(order.begin(), order.end(), generator);
+
+  // Samples hashed by cells of edge radius, the samples closer than radius to
+  // a point are in the 27 cells around it
+  Eigen::Vector3f lower = pointSet.col(order[0]);
+  for (Eigen::Index i : order)
+  {
+    lower = lower.cwiseMin(pointSet.col(i));
+  }
+  std::unordered_map< long long, std::vector< Eigen::Index > > cells;
+  std::vector< Eigen::Index >                                  accepted;
+  const double squaredRadius = radius * radius;
+  for (Eigen::Index i : order)
+  {
+    const Eigen::Array3d point = pointSet.col(i).cast< double >().array();
+    const Eigen::Array< long long, 3, 1 > cell =
+      ((point - lower.cast< double >().array()) / radius)
+        .floor()
+        .cast< long long >();
+
+    bool isFree = true;
+    for (long long dx = -1; dx <= 1 && isFree; dx++)
+    {
+      for (long long dy = -1; dy <= 1 && isFree; dy++)
+      {
+        for (long long dz = -1; dz <= 1 && isFree; dz++)
+        {
+          auto neighbours =
+            cells.find(CellKey(cell(0) + dx, cell(1) + dy, cell(2) + dz));
+          if (neighbours == cells.end())
+          {
+            continue;
+          }
+          for (Eigen::Index j : neighbours->second)
+          {
+            if ((pointSet.col(j).cast< double >().array() - point)
+                  .matrix()
+                  .squaredNorm() < squaredRadius)
+            {
+              isFree = false;
+              break;
+            }
+          }
+        }
+      }
+    }
+    if (isFree)
+    {
+      cells[CellKey(cell(0), cell(1), cell(2))].push_back(i);
+      accepted.push_back(i);
+    }
+  }
+
+  // Keep the samples in the order of the point set
+  std::sort(accepted.begin(), accepted.end());
+  Eigen::Matrix3Xf samples(3, accepted.size());
+  for (size_t i = 0; i < accepted.size(); i++)
+  {
+    samples.col(i) = pointSet.col(accepted[i]);
+  }
+  return samples;
+}
+
+Eigen::Matrix3Xf AlphaShape::poissonDiskSubset(
+  const Eigen::Ref< const Eigen::Matrix3Xf >& pointSet, int count)
+{
+  Eigen::Matrix3Xf samples = poissonDiskSample(pointSet, 0.);
+  if (count <= 0 || samples.cols() <= count)
+  {
+    return samples;
+  }
+
+  // The number of samples on a surface goes with 1 / radius^2, start from the
+  // radius which would spread them over a square as wide as the bounding box
+  const double diagonal =
+    (samples.rowwise().maxCoeff() - samples.rowwise().minCoeff())
+      .cast< double >()
+      .norm();
+  double radius = diagonal / std::sqrt(double(count));
+  for (int i = 0; i < kMaxRadiusCorrections; i++)
+  {
+    samples               = poissonDiskSample(pointSet, radius);
+    const double relative = double(samples.cols()) / count;
+    if (std::abs(relative - 1.) <= kSampleCountTolerance)
+    {
+      break;
+    }
+    radius *= std::sqrt(relative);
+  }
+  return samples;
+}
+
+vtkSmartPointer< vtkPolyData >
+  AlphaShape::reconstruct(
+    const Eigen::Ref< const Eigen::Matrix3Xf >& pointSet) const
+{
+  vtkSmartPointer< vtkPolyData > surface =
+    vtkSmartPointer< vtkPolyData >::New();
+
+  Eigen::Matrix3Xf samples = poissonDiskSubset(pointSet, NumberOfSamples);
+  if (samples.cols() < 4)
+  {
+    return surface;
+  }
+  const double diagonal =
+    (samples.rowwise().maxCoeff() - samples.rowwise().minCoeff())
+      .cast< double >()
+      .norm();
+
+  vtkSmartPointer< vtkPolyData > input = vtkSmartPointer< vtkPolyData >::New();
+  input->SetPoints(PointSetUtilities(std::move(samples)).getVTKPointSet());
+
+  // The points mostly sample surfaces, so the triangles of the alpha complex
+  // which are not part of a tetrahedron belong to the shape as well. Its
+  // boundary is made of them and of the faces of a single tetrahedron.
+  vtkSmartPointer< vtkDelaunay3D > delaunay =
+    vtkSmartPointer< vtkDelaunay3D >::New();
+  delaunay->SetInputData(input);
+  delaunay->SetAlpha(AlphaPercentage / 100. * diagonal);
+  delaunay->AlphaTetsOn();
+  delaunay->AlphaTrisOn();
+  delaunay->AlphaLinesOff();
+  delaunay->AlphaVertsOff();
+
+  vtkSmartPointer< vtkDataSetSurfaceFilter > boundary =
+    vtkSmartPointer< vtkDataSetSurfaceFilter >::New();
+  boundary->SetInputConnection(delaunay->GetOutputPort());
+  boundary->Update();
+
+  surface->ShallowCopy(boundary->GetOutput());
+  return surface;
+}
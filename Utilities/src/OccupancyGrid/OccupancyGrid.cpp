@@ -0,0 +1,263 @@
+/**
+ * @file OccupancyGrid.cpp
+ * @brief Binary voxel occupancy of a point set in a reference image grid.
+ *
+ */
+
+#include "OccupancyGrid/OccupancyGrid.hpp"
+#include "ThreadPool/ThreadPool.hpp"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+// Squared distance standing for no voxel of the mask along a line, finite so
+// that the parabola intersections stay defined
+static const float kFar = 1e20f;
+
+// Squared distance transform of one line of samples spaced by spacing (mm),
+// the lower envelope of the parabolas rooted at each sample (Felzenszwalb and
+// Huttenlocher). v, z and f are scratch buffers of n, n + 1 and n elements.
+static void DistanceTransformLine(float* line, long n, long stride,
+                                  double spacing, long* v, double* z,
+                                  double* f)
+{
+  for (long q = 0; q < n; q++)
+  {
+    f[q] = line[q * stride];
+  }
+  // Intersection of the parabolas rooted at samples q and p, in mm
+  auto intersection = [&](long q, long p) {
+    const double xq = q * spacing, xp = p * spacing;
+    return ((f[q] + xq * xq) - (f[p] + xp * xp)) / (2. * (xq - xp));
+  };
+
+  long k = 0;
+  v[0]   = 0;
+  z[0]   = -HUGE_VAL;
+  z[1]   = HUGE_VAL;
+  for (long q = 1; q < n; q++)
+  {
+    double s = intersection(q, v[k]);
+    while (s <= z[k])
+    {
+      k--;
+      s = intersection(q, v[k]);
+    }
+    k++;
+    v[k]     = q;
+    z[k]     = s;
+    z[k + 1] = HUGE_VAL;
+  }
+
+  k = 0;
+  for (long q = 0; q < n; q++)
+  {
+    while (z[k + 1] < q * spacing)
+    {
+      k++;
+    }
+    const double d   = (q - v[k]) * spacing;
+    line[q * stride] = float(d * d + f[v[k]]);
+  }
+}
+
+OccupancyGrid::OccupancyGrid()
+  : IJKToPosition(Eigen::Matrix4d::Identity())
+  , Offset(Eigen::Array3i::Zero())
+  , Dimensions(Eigen::Array3i::Zero())
+  , Lower(Eigen::Array3i::Zero())
+  , Upper(Eigen::Array3i::Constant(-1))
+{
+}
+
+OccupancyGrid::OccupancyGrid(
+  const Eigen::Matrix4d&                      ijkToPosition,
+  const Eigen::Array3i&                       lower,
+  const Eigen::Array3i&                       upper,
+  const Eigen::Ref< const Eigen::Matrix3Xf >& pointSet, double margin)
+  : OccupancyGrid()
+{
+  IJKToPosition = ijkToPosition;
+  Lower         = lower;
+  Upper         = upper;
+  const Eigen::Matrix4d positionToIJK = ijkToPosition.inverse();
+
+  // Voxels of the points and their bounding box. The points outside the
+  // extent are kept, they may close the surface around voxels inside it.
+  std::vector< Eigen::Array3i > pointVoxels;
+  pointVoxels.reserve(pointSet.cols());
+  Eigen::Array3i first = Eigen::Array3i::Constant(INT_MAX);
+  Eigen::Array3i last  = Eigen::Array3i::Constant(INT_MIN);
+  for (Eigen::Index i = 0; i < pointSet.cols(); i++)
+  {
+    if (!pointSet.col(i).allFinite())
+    {
+      continue;
+    }
+    const Eigen::Vector3d ijk =
+      positionToIJK.topLeftCorner< 3, 3 >() * pointSet.col(i).cast< double >() +
+      positionToIJK.topRightCorner< 3, 1 >();
+    pointVoxels.push_back(ijk.array().round().cast< int >());
+    first = first.min(pointVoxels.back());
+    last  = last.max(pointVoxels.back());
+  }
+  if (pointVoxels.empty())
+  {
+    return;
+  }
+
+  // Margin in voxels along each axis, and the empty border. The border is
+  // never cut, so the outside of the points can be reached from every side.
+  const Eigen::Array3d spacing =
+    ijkToPosition.topLeftCorner< 3, 3 >().colwise().norm().transpose().array();
+  const Eigen::Array3i padding =
+    (std::max(margin, 0.) / spacing).ceil().cast< int >() + 1;
+
+  Offset     = first - padding;
+  Dimensions = last - first + 2 * padding + 1;
+  Voxels.assign(Dimensions.cast< long >().prod(), 0);
+  for (const Eigen::Array3i& voxel : pointVoxels)
+  {
+    const Eigen::Array3i index = voxel - Offset;
+    Voxels[(long(index(2)) * Dimensions(1) + index(1)) * Dimensions(0) +
+           index(0)] = 1;
+  }
+}
+
+void OccupancyGrid::crop()
+{
+  const Eigen::Array3i first = Offset.max(Lower);
+  const Eigen::Array3i last  = (Offset + Dimensions - 1).min(Upper);
+  if ((last < first).any())
+  {
+    Offset = Lower;
+    Dimensions.setZero();
+    Voxels.clear();
+    return;
+  }
+  if ((first == Offset).all() && (last == Offset + Dimensions - 1).all())
+  {
+    return;
+  }
+
+  const Eigen::Array3i         dimensions = last - first + 1;
+  std::vector< unsigned char > voxels(dimensions.cast< long >().prod());
+  for (int k = 0; k < dimensions(2); k++)
+  {
+    for (int j = 0; j < dimensions(1); j++)
+    {
+      const Eigen::Array3i index = Eigen::Array3i(0, j, k) + first - Offset;
+      std::copy_n(Voxels.begin() +
+                    (long(index(2)) * Dimensions(1) + index(1)) *
+                      Dimensions(0) +
+                    index(0),
+                  dimensions(0),
+                  voxels.begin() +
+                    (long(k) * dimensions(1) + j) * dimensions(0));
+    }
+  }
+  Offset     = first;
+  Dimensions = dimensions;
+  Voxels.swap(voxels);
+}
+
+long OccupancyGrid::count() const
+{
+  return std::count(Voxels.begin(), Voxels.end(), 1);
+}
+
+std::vector< float > OccupancyGrid::squaredDistanceTo(
+  const std::vector< unsigned char >& mask) const
+{
+  std::vector< float > distances(mask.size());
+  for (size_t i = 0; i < mask.size(); i++)
+  {
+    distances[i] = mask[i] ? 0.f : kFar;
+  }
+
+  // Separable transform, one pass of 1D transforms along each axis
+  const Eigen::Array3d spacing =
+    IJKToPosition.topLeftCorner< 3, 3 >().colwise().norm().transpose().array();
+  const long strides[] = {1, Dimensions(0),
+                          long(Dimensions(0)) * Dimensions(1)};
+  for (int a = 0; a < 3; a++)
+  {
+    const long n        = Dimensions(a);
+    const long no_lines = long(mask.size()) / n;
+    ThreadPool::global().parallelFor(no_lines, 64, [&](long begin, long end) {
+      std::vector< long >   v(n);
+      std::vector< double > z(n + 1), f(n);
+      for (long l = begin; l < end; l++)
+      {
+        // First voxel of line l, the lines run over the two other axes
+        const long start = (l / strides[a]) * strides[a] * n + l % strides[a];
+        DistanceTransformLine(distances.data() + start, n, strides[a],
+                              spacing(a), v.data(), z.data(), f.data());
+      }
+    });
+  }
+  return distances;
+}
+
+void OccupancyGrid::fill(double radius)
+{
+  if (Voxels.empty())
+  {
+    return;
+  }
+  const float squaredRadius = float(radius * radius);
+
+  // Voxels further than radius from the occupied ones which are connected to
+  // a side of the grid are outside
+  const std::vector< float > toOccupied = squaredDistanceTo(Voxels);
+  std::vector< unsigned char > outside(Voxels.size(), 0);
+  std::vector< long >          stack;
+  auto                         visit = [&](long i) {
+    if (!outside[i] && toOccupied[i] > squaredRadius)
+    {
+      outside[i] = 1;
+      stack.push_back(i);
+    }
+  };
+  const long strides[] = {1, Dimensions(0),
+                          long(Dimensions(0)) * Dimensions(1)};
+  for (long i = 0; i < long(Voxels.size()); i++)
+  {
+    for (int a = 0; a < 3; a++)
+    {
+      const long index = (i / strides[a]) % Dimensions(a);
+      if (index == 0 || index == Dimensions(a) - 1)
+      {
+        visit(i);
+      }
+    }
+  }
+  while (!stack.empty())
+  {
+    const long i = stack.back();
+    stack.pop_back();
+    for (int a = 0; a < 3; a++)
+    {
+      const long index = (i / strides[a]) % Dimensions(a);
+      if (index > 0)
+      {
+        visit(i - strides[a]);
+      }
+      if (index < Dimensions(a) - 1)
+      {
+        visit(i + strides[a]);
+      }
+    }
+  }
+
+  // The rest, shrunk back by radius, closes the occupied voxels
+  const std::vector< float > toOutside = squaredDistanceTo(outside);
+  for (size_t i = 0; i < Voxels.size(); i++)
+  {
+    if (toOutside[i] > squaredRadius)
+    {
+      Voxels[i] = 1;
+    }
+  }
+  crop();
+}
@@ -0,0 +1,44 @@
+/**
+ * @file PointCloudBuilder.cpp
+ * @brief Append-only buffer used to generate point sets.
+ *
+ */
+
+#include "PointCloudBuilder/PointCloudBuilder.hpp"
+#include <algorithm>
+#include <utility>
+
+PointCloudBuilder::PointCloudBuilder(Eigen::Index capacity)
+  : PointSet(3, capacity)
+  , NumberOfPoints(0)
+{
+}
+
+void PointCloudBuilder::grow(Eigen::Index minCapacity)
+{
+  reserve(std::max(minCapacity, 2 * PointSet.cols()));
+}
+
+void PointCloudBuilder::reserve(Eigen::Index capacity)
+{
+  if (capacity > PointSet.cols())
+  {
+    // Only the stored points are kept, the new columns are left uninitialized
+    PointSet.conservativeResize(3, capacity);
+  }
+}
+
+void PointCloudBuilder::clear()
+{
+  NumberOfPoints = 0;
+}
+
+Eigen::Matrix3Xf PointCloudBuilder::release()
+{
+  // Shrinking a column major matrix keeps its leading columns in place
+  PointSet.conservativeResize(3, NumberOfPoints);
+  Eigen::Matrix3Xf pointSet(std::move(PointSet));
+  PointSet.resize(3, 0);
+  NumberOfPoints = 0;
+  return pointSet;
+}
@@ -0,0 +1,157 @@
+/**
+ * @file PointGridIndex.cpp
+ * @brief Uniform grid over a point set for sphere queries.
+ *
+ */
+
+#include "PointGridIndex/PointGridIndex.hpp"
+#include <algorithm>
+#include <cmath>
+
+PointGridIndex::PointGridIndex()
+  : Origin(Eigen::Vector3d::Zero())
+  , CellSize(1.)
+  , Dimensions(Eigen::Array3i::Zero())
+  , CellStart(1, 0)
+{
+}
+
+PointGridIndex::PointGridIndex(const Eigen::Matrix3Xf& pointSet,
+                               double                  cellSize)
+  : PointGridIndex()
+{
+  // Bounding box of the finite points
+  std::vector< Eigen::Index > finitePoints;
+  finitePoints.reserve(pointSet.cols());
+  Eigen::Vector3d lower = Eigen::Vector3d::Constant(HUGE_VAL);
+  Eigen::Vector3d upper = Eigen::Vector3d::Constant(-HUGE_VAL);
+  for (Eigen::Index i = 0; i < pointSet.cols(); i++)
+  {
+    if (pointSet.col(i).allFinite())
+    {
+      const Eigen::Vector3d point = pointSet.col(i).cast< double >();
+      lower                       = lower.cwiseMin(point);
+      upper                       = upper.cwiseMax(point);
+      finitePoints.push_back(i);
+    }
+  }
+  if (finitePoints.empty())
+  {
+    return;
+  }
+
+  // Doubles the cells until there are at most a few of them per point
+  const double maxNumberOfCells =
+    std::max< double >(64., 4. * finitePoints.size());
+  CellSize = cellSize > 0. ? cellSize : 1.;
+  Eigen::Array3d extent = (upper - lower).array();
+  while (((extent / CellSize).floor() + 1.).prod() > maxNumberOfCells)
+  {
+    CellSize *= 2.;
+  }
+  Origin     = lower;
+  Dimensions = ((extent / CellSize).floor() + 1.).cast< int >();
+
+  // Counting sort of the points by cell, which keeps them in increasing order
+  // within each cell
+  std::vector< Eigen::Index > cellOfPoint(finitePoints.size());
+  CellStart.assign(Dimensions.prod() + 1, 0);
+  for (size_t p = 0; p < finitePoints.size(); p++)
+  {
+    const Eigen::Array3d position =
+      (pointSet.col(finitePoints[p]).cast< double >() - Origin).array() /
+      CellSize;
+    const Eigen::Array3i cell =
+      position.floor().cast< int >().max(0).min(Dimensions - 1);
+    cellOfPoint[p] =
+      (cell(2) * Dimensions(1) + cell(1)) * Dimensions(0) + cell(0);
+    CellStart[cellOfPoint[p] + 1]++;
+  }
+  for (size_t c = 1; c < CellStart.size(); c++)
+  {
+    CellStart[c] += CellStart[c - 1];
+  }
+  Points.resize(3, finitePoints.size());
+  PointIndices.resize(finitePoints.size());
+  std::vector< Eigen::Index > next(CellStart.begin(), CellStart.end() - 1);
+  for (size_t p = 0; p < finitePoints.size(); p++)
+  {
+    const Eigen::Index column = next[cellOfPoint[p]]++;
+    Points.col(column)        = pointSet.col(finitePoints[p]);
+    PointIndices[column]      = finitePoints[p];
+  }
+}
+
+void PointGridIndex::appendRange(std::vector< Range >& ranges,
+                                 const Range&          range)
+{
+  if (range.first == range.second)
+  {
+    return;
+  }
+  if (!ranges.empty() && ranges.back().second == range.first)
+  {
+    ranges.back().second = range.second;
+  }
+  else
+  {
+    ranges.push_back(range);
+  }
+}
+
+void PointGridIndex::querySphere(const Eigen::Vector3d& center, double radius,
+                                 std::vector< Range >& inside,
+                                 std::vector< Range >& crossing) const
+{
+  if (Points.cols() == 0 || !(radius >= 0.))
+  {
+    return;
+  }
+
+  // The margin absorbs the rounding of the points into their cells and of
+  // the distance computed by the caller
+  const double margin      = 1e-3 * CellSize;
+  const double outerRadius = radius + margin;
+  const double innerRadius = radius - margin;
+
+  // Range of cells overlapping the bounding box of the sphere
+  const Eigen::Array3d relativeCenter = (center - Origin).array() / CellSize;
+  const Eigen::Array3i first =
+    (relativeCenter - outerRadius / CellSize).floor().max(0.).cast< int >();
+  const Eigen::Array3i last =
+    (relativeCenter + outerRadius / CellSize)
+      .floor()
+      .min((Dimensions - 1).cast< double >())
+      .cast< int >();
+
+  for (int z = first(2); z <= last(2); z++)
+  {
+    for (int y = first(1); y <= last(1); y++)
+    {
+      for (int x = first(0); x <= last(0); x++)
+      {
+        // Closest and farthest points of the cell from the center
+        const Eigen::Array3d lower =
+          Origin.array() + Eigen::Array3d(x, y, z) * CellSize;
+        const Eigen::Array3d upper   = lower + CellSize;
+        const Eigen::Array3d below   = lower - center.array();
+        const Eigen::Array3d above   = center.array() - upper;
+        const double         nearest = below.max(above).max(0.).square().sum();
+        const double farthest = below.abs().max(above.abs()).square().sum();
+        if (nearest > outerRadius * outerRadius)
+        {
+          continue;
+        }
+
+        // Cells along x are consecutive, so their ranges are merged
+        const int   cell  = (z * Dimensions(1) + y) * Dimensions(0) + x;
+        const Range range = Range(CellStart[cell], CellStart[cell + 1]);
+        appendRange(
+          (innerRadius > 0. && farthest <= innerRadius * innerRadius) ?
+            inside :
+            crossing,
+          range);
+      }
+    }
+  }
+}
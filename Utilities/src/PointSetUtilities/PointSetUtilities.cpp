@@ -9,45 +9,403 @@
  */
 
 #include "PointSetUtilities/PointSetUtilities.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
 #include <fstream>
 #include <iostream>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include <vtkCellArray.h>
+#include <vtkFloatArray.h>
+#include <vtkIdTypeArray.h>
+#include <vtkTypeInt32Array.h>
+#include <vtkVersion.h>
+// QT Includes
+#include <QFile>
+#include <QSaveFile>
+
+// Bumped whenever the layout of a .points file changes
+static const uint32_t kPointsVersion  = 1;
+static const char     kPointsMagic[4] = {'N', 'R', 'P', 'S'};
+
+// Header of a .points file, followed by 3 * NumberOfPoints floats in the byte
+// order of the machine that wrote it
+struct PointsHeader
+{
+  char     Magic[4];
+  uint32_t Version;
+  uint64_t NumberOfPoints;
+};
+
+// Header of the triangle block which follows the points of a mesh, followed
+// by 3 * NumberOfTriangles 32 bit point indices
+static const char kTrianglesMagic[4] = {'N', 'R', 'T', 'R'};
+struct TrianglesHeader
+{
+  char     Magic[4];
+  uint32_t Version;
+  uint64_t NumberOfTriangles;
+};
+
+// Size of the chunks the .xyz text is written in
+static const size_t kXyzBufferSize = 1 << 20;
+
+// Owners of the memory wrapped by VTK arrays, point sets or mapped files, by
+// the address of the wrapped values. An array only hands back that address
+// when it frees them, so this is where it holds its reference to their owner.
+struct SharedArrays
+{
+  std::mutex Mutex;
+  std::unordered_multimap< void*, std::shared_ptr< const void > > Owners;
+};
+
+// Never destroyed, arrays may still be freed while static objects are
+static SharedArrays& GetSharedArrays()
+{
+  static SharedArrays* sharedArrays = new SharedArrays;
+  return *sharedArrays;
+}
+
+// Keeps owner alive until the array wrapping values is freed
+static void ShareArray(void* values, std::shared_ptr< const void > owner)
+{
+  SharedArrays&                 shared = GetSharedArrays();
+  std::lock_guard< std::mutex > lock(shared.Mutex);
+  shared.Owners.emplace(values, std::move(owner));
+}
+
+// Free function of the VTK arrays wrapping shared values
+static void ReleaseSharedArray(void* values)
+{
+  SharedArrays&                 shared = GetSharedArrays();
+  std::lock_guard< std::mutex > lock(shared.Mutex);
+
+  auto owner = shared.Owners.find(values);
+  if (owner != shared.Owners.end())
+  {
+    shared.Owners.erase(owner);
+  }
+}
+
+// Coordinate array of 3 component tuples wrapping those of owner
+static vtkSmartPointer< vtkFloatArray >
+  WrapCoordinates(float* coordinates, Eigen::Index numberOfPoints,
+                  std::shared_ptr< const void > owner)
+{
+  ShareArray(coordinates, std::move(owner));
+  vtkSmartPointer< vtkFloatArray > array =
+    vtkSmartPointer< vtkFloatArray >::New();
+  array->SetNumberOfComponents(3);
+  array->SetArray(coordinates, 3 * numberOfPoints, 0,
+                  vtkFloatArray::VTK_DATA_ARRAY_USER_DEFINED);
+  array->SetArrayFreeFunction(ReleaseSharedArray);
+  return array;
+}
 
 PointSetUtilities::PointSetUtilities(Eigen::Matrix3Xf eigenPointSet)
+  : EigenPointSet(
+      std::make_shared< Eigen::Matrix3Xf >(std::move(eigenPointSet)))
 {
-  EigenPointSet = eigenPointSet;
 }
 
 void PointSetUtilities::saveToXyz(const char* fileName)
 {
   // std::cout << "Number of points to be saved in " << fileName
-  //           << " are: " << EigenPointSet.cols() << std::endl;
-  std::ofstream output(fileName, std::ofstream::out);
-  for (int i = 0; i < EigenPointSet.cols(); i++)
+  //           << " are: " << EigenPointSet->cols() << std::endl;
+  std::ofstream output(fileName, std::ofstream::out | std::ofstream::binary);
+
+  // Formatted into a buffer written out in large chunks, a flush per line
+  // made the file system calls dominate
+  std::vector< char > buffer(kXyzBufferSize);
+  size_t              used = 0;
+  char                line[128];
+  for (Eigen::Index i = 0; i < EigenPointSet->cols(); i++)
   {
-    output << EigenPointSet(0, i) << " " << EigenPointSet(1, i) << " "
-           << EigenPointSet(2, i) << " 0.00 0.00 0.00" << std::endl;
+    const int length = std::snprintf(
+      line, sizeof(line), "%g %g %g 0.00 0.00 0.00\n", (*EigenPointSet)(0, i),
+      (*EigenPointSet)(1, i), (*EigenPointSet)(2, i));
+    if (used + length > buffer.size())
+    {
+      output.write(buffer.data(), used);
+      used = 0;
+    }
+    std::memcpy(buffer.data() + used, line, length);
+    used += length;
   }
+  output.write(buffer.data(), used);
   output.close();
 }
 
+bool PointSetUtilities::saveToPoints(const char* fileName)
+{
+  return saveToPoints(fileName, *EigenPointSet);
+}
+
+bool PointSetUtilities::saveToPoints(const char*             fileName,
+                                     const Eigen::Matrix3Xf& pointSet)
+{
+  // QSaveFile only replaces the file once all of it has been written
+  QSaveFile file(QString::fromLocal8Bit(fileName));
+  if (!file.open(QIODevice::WriteOnly))
+  {
+    return false;
+  }
+  if (!writePoints(file, pointSet))
+  {
+    file.cancelWriting();
+    return false;
+  }
+  return file.commit();
+}
+
+bool PointSetUtilities::saveToPoints(const char*             fileName,
+                                     const Eigen::Matrix3Xf& pointSet,
+                                     const Eigen::Matrix3Xi& triangles)
+{
+  QSaveFile file(QString::fromLocal8Bit(fileName));
+  if (!file.open(QIODevice::WriteOnly))
+  {
+    return false;
+  }
+  if (!writePoints(file, pointSet) || !writeTriangles(file, triangles))
+  {
+    file.cancelWriting();
+    return false;
+  }
+  return file.commit();
+}
+
+bool PointSetUtilities::loadFromPoints(const char*       fileName,
+                                       Eigen::Matrix3Xf& pointSet)
+{
+  QFile file(QString::fromLocal8Bit(fileName));
+  return file.open(QIODevice::ReadOnly) && readPoints(file, pointSet);
+}
+
+bool PointSetUtilities::writePoints(QIODevice&              device,
+                                    const Eigen::Matrix3Xf& pointSet)
+{
+  PointsHeader header;
+  std::memcpy(header.Magic, kPointsMagic, sizeof(kPointsMagic));
+  header.Version        = kPointsVersion;
+  header.NumberOfPoints = pointSet.cols();
+  const qint64 bytes    = pointSet.size() * sizeof(float);
+
+  return device.write(reinterpret_cast< const char* >(&header),
+                      sizeof(header)) == sizeof(header) &&
+         device.write(reinterpret_cast< const char* >(pointSet.data()),
+                      bytes) == bytes;
+}
+
+bool PointSetUtilities::writeTriangles(QIODevice&              device,
+                                       const Eigen::Matrix3Xi& triangles)
+{
+  static_assert(sizeof(int) == 4, "The point indices are stored as 32 bits");
+  TrianglesHeader header;
+  std::memcpy(header.Magic, kTrianglesMagic, sizeof(kTrianglesMagic));
+  header.Version           = kPointsVersion;
+  header.NumberOfTriangles = triangles.cols();
+  const qint64 bytes       = triangles.size() * sizeof(int);
+
+  return device.write(reinterpret_cast< const char* >(&header),
+                      sizeof(header)) == sizeof(header) &&
+         device.write(reinterpret_cast< const char* >(triangles.data()),
+                      bytes) == bytes;
+}
+
+bool PointSetUtilities::readPoints(QIODevice&        device,
+                                   Eigen::Matrix3Xf& pointSet)
+{
+  PointsHeader header;
+  if (device.read(reinterpret_cast< char* >(&header), sizeof(header)) !=
+        sizeof(header) ||
+      std::memcmp(header.Magic, kPointsMagic, sizeof(kPointsMagic)) != 0 ||
+      header.Version != kPointsVersion)
+  {
+    return false;
+  }
+  // The triangles of a mesh may follow the points
+  const qint64 bytes = header.NumberOfPoints * 3 * sizeof(float);
+  if (!device.isSequential() && device.size() - device.pos() < bytes)
+  {
+    return false;
+  }
+
+  pointSet.resize(3, header.NumberOfPoints);
+  return device.read(reinterpret_cast< char* >(pointSet.data()), bytes) ==
+         bytes;
+}
+
 void PointSetUtilities::setEigenPointSet(Eigen::Matrix3Xf eigenPointSet)
 {
-  EigenPointSet = eigenPointSet;
+  // VTK arrays may still point on the current point set
+  EigenPointSet =
+    std::make_shared< Eigen::Matrix3Xf >(std::move(eigenPointSet));
 }
 
-Eigen::Matrix3Xf PointSetUtilities::getEigenPointSet()
+const Eigen::Matrix3Xf& PointSetUtilities::getEigenPointSet() const
 {
-  return EigenPointSet;
+  return *EigenPointSet;
 }
 
-vtkSmartPointer< vtkPoints > PointSetUtilities::getVTKPointSet()
+vtkSmartPointer< vtkPoints > PointSetUtilities::getVTKPointSet() const
 {
   vtkSmartPointer< vtkPoints > pointSet = vtkSmartPointer< vtkPoints >::New();
-
-  for (int i = 0; i < EigenPointSet.cols(); i++)
+  pointSet->SetDataTypeToFloat();
+  if (EigenPointSet->size() == 0)
   {
-    pointSet->InsertPoint(i, EigenPointSet.col(i).data());
+    return pointSet;
   }
 
+  // The columns of the point set are its points, one after the other, which
+  // is the layout of an array of 3 component tuples
+  pointSet->SetData(WrapCoordinates(EigenPointSet->data(),
+                                    EigenPointSet->cols(), EigenPointSet));
+
   return pointSet;
-}
\ No newline at end of file
+}
+
+MappedPointSet::MappedPointSet(const QString& fileName)
+  : File(fileName)
+  , Data(NULL)
+  , NumberOfPoints(0)
+  , TrianglesOffset(0)
+  , NumberOfTriangles(0)
+{
+  PointsHeader header;
+  const qint64 size = File.open(QIODevice::ReadOnly) ? File.size() : 0;
+  if (size < qint64(sizeof(header)))
+  {
+    return;
+  }
+  // Unmapped when the file is closed. The pages are writable so that VTK
+  // arrays can wrap them, and private so that writes stay in memory.
+  uchar* data = File.map(0, size, QFileDevice::MapPrivateOption);
+  if (data == NULL)
+  {
+    return;
+  }
+
+  std::memcpy(&header, data, sizeof(header));
+  const qint64 pointsEnd =
+    sizeof(header) + qint64(header.NumberOfPoints) * 3 * sizeof(float);
+  if (std::memcmp(header.Magic, kPointsMagic, sizeof(kPointsMagic)) != 0 ||
+      header.Version != kPointsVersion || size < pointsEnd)
+  {
+    File.close();
+    return;
+  }
+
+  if (size > pointsEnd)
+  {
+    TrianglesHeader trianglesHeader;
+    if (size - pointsEnd < qint64(sizeof(trianglesHeader)))
+    {
+      File.close();
+      return;
+    }
+    std::memcpy(&trianglesHeader, data + pointsEnd, sizeof(trianglesHeader));
+    const qint64 trianglesEnd =
+      pointsEnd + sizeof(trianglesHeader) +
+      qint64(trianglesHeader.NumberOfTriangles) * 3 * sizeof(int);
+    if (std::memcmp(trianglesHeader.Magic, kTrianglesMagic,
+                    sizeof(kTrianglesMagic)) != 0 ||
+        trianglesHeader.Version != kPointsVersion || size != trianglesEnd)
+    {
+      File.close();
+      return;
+    }
+    TrianglesOffset   = pointsEnd + sizeof(trianglesHeader);
+    NumberOfTriangles = trianglesHeader.NumberOfTriangles;
+  }
+
+  Data           = data;
+  NumberOfPoints = header.NumberOfPoints;
+}
+
+MappedPointSet::Points MappedPointSet::getPoints() const
+{
+  if (Data == NULL)
+  {
+    return Points(NULL, 3, 0);
+  }
+  return Points(reinterpret_cast< const float* >(Data + sizeof(PointsHeader)),
+                3, NumberOfPoints);
+}
+
+MappedPointSet::Triangles MappedPointSet::getTriangles() const
+{
+  if (Data == NULL || TrianglesOffset == 0)
+  {
+    return Triangles(NULL, 3, 0);
+  }
+  return Triangles(reinterpret_cast< const int* >(Data + TrianglesOffset), 3,
+                   NumberOfTriangles);
+}
+
+vtkSmartPointer< vtkPolyData > MappedPointSet::getVTKMesh(
+  const std::shared_ptr< const MappedPointSet >& mesh)
+{
+  if (mesh == nullptr || !mesh->isValid() || mesh->NumberOfTriangles == 0)
+  {
+    return NULL;
+  }
+  // VTK does not check the corners of the cells it is given
+  const Triangles triangles = mesh->getTriangles();
+  if (triangles.minCoeff() < 0 || triangles.maxCoeff() >= mesh->NumberOfPoints)
+  {
+    return NULL;
+  }
+
+  vtkSmartPointer< vtkPoints > points = vtkSmartPointer< vtkPoints >::New();
+  points->SetData(WrapCoordinates(
+    reinterpret_cast< float* >(mesh->Data + sizeof(PointsHeader)),
+    mesh->NumberOfPoints, mesh));
+
+  vtkSmartPointer< vtkCellArray > polys =
+    vtkSmartPointer< vtkCellArray >::New();
+#if VTK_MAJOR_VERSION >= 9
+  // The cells are the ranges between consecutive offsets of the connectivity,
+  // which is the triangle block itself
+  int* corners = reinterpret_cast< int* >(mesh->Data + mesh->TrianglesOffset);
+  ShareArray(corners, mesh);
+  vtkSmartPointer< vtkTypeInt32Array > connectivity =
+    vtkSmartPointer< vtkTypeInt32Array >::New();
+  connectivity->SetArray(corners, triangles.size(), 0,
+                         vtkTypeInt32Array::VTK_DATA_ARRAY_USER_DEFINED);
+  connectivity->SetArrayFreeFunction(ReleaseSharedArray);
+
+  vtkSmartPointer< vtkTypeInt32Array > offsets =
+    vtkSmartPointer< vtkTypeInt32Array >::New();
+  offsets->SetNumberOfValues(triangles.cols() + 1);
+  for (Eigen::Index i = 0; i <= triangles.cols(); i++)
+  {
+    offsets->SetValue(i, 3 * i);
+  }
+  if (!polys->SetData(offsets, connectivity))
+  {
+    return NULL;
+  }
+#else
+  vtkSmartPointer< vtkIdTypeArray > cells =
+    vtkSmartPointer< vtkIdTypeArray >::New();
+  cells->SetNumberOfValues(4 * triangles.cols());
+  for (Eigen::Index i = 0; i < triangles.cols(); i++)
+  {
+    cells->SetValue(4 * i, 3);
+    for (Eigen::Index j = 0; j < 3; j++)
+    {
+      cells->SetValue(4 * i + 1 + j, triangles(j, i));
+    }
+  }
+  polys->SetCells(triangles.cols(), cells);
+#endif
+
+  vtkSmartPointer< vtkPolyData > polyData =
+    vtkSmartPointer< vtkPolyData >::New();
+  polyData->SetPoints(points);
+  polyData->SetPolys(polys);
+  return polyData;
+}
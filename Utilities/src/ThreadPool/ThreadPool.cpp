@@ -0,0 +1,143 @@
+/**
+ * @file ThreadPool.cpp
+ * @brief Pool of worker threads for data parallel loops.
+ *
+ */
+
+#include "ThreadPool/ThreadPool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <stdlib.h>
+
+namespace
+{
+// Set on the threads currently running a loop body to detect nested loops
+thread_local bool InsideParallelFor = false;
+}  // namespace
+
+struct ThreadPool::Loop
+{
+  const RangeFunction* Body;
+  long                 Count;
+  long                 GrainSize;
+  std::atomic< long >  NextIndex;
+};
+
+ThreadPool::ThreadPool(unsigned int numberOfThreads)
+  : CurrentLoop(NULL)
+  , LoopGeneration(0)
+  , ActiveWorkers(0)
+  , Stopping(false)
+{
+  if (numberOfThreads == 0)
+  {
+    numberOfThreads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  for (unsigned int i = 1; i < numberOfThreads; i++)
+  {
+    Workers.push_back(std::thread(&ThreadPool::workerMain, this));
+  }
+}
+
+ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard< std::mutex > lock(Mutex);
+    Stopping = true;
+  }
+  LoopStarted.notify_all();
+  for (std::thread& worker : Workers)
+  {
+    worker.join();
+  }
+}
+
+ThreadPool& ThreadPool::global()
+{
+  // NEUROROBOT_NUM_THREADS overrides the number of hardware threads
+  static ThreadPool pool([] {
+    const char* numberOfThreads = getenv("NEUROROBOT_NUM_THREADS");
+    return (numberOfThreads != NULL) ? std::max(0, atoi(numberOfThreads)) : 0;
+  }());
+  return pool;
+}
+
+void ThreadPool::parallelFor(long count, long grainSize,
+                             const RangeFunction& body)
+{
+  if (count <= 0)
+  {
+    return;
+  }
+  grainSize = std::max(1L, grainSize);
+
+  // Nothing to share, or a nested loop whose workers are already busy
+  if (Workers.empty() || count <= grainSize || InsideParallelFor)
+  {
+    body(0, count);
+    return;
+  }
+
+  std::lock_guard< std::mutex > loopLock(LoopMutex);
+  Loop                          loop;
+  loop.Body      = &body;
+  loop.Count     = count;
+  loop.GrainSize = grainSize;
+  loop.NextIndex = 0;
+  {
+    std::lock_guard< std::mutex > lock(Mutex);
+    CurrentLoop = &loop;
+    LoopGeneration++;
+  }
+  LoopStarted.notify_all();
+
+  runChunks(loop);
+
+  // Workers that have not joined the loop by now will not see it, wait for
+  // the ones that did before the loop goes out of scope
+  std::unique_lock< std::mutex > lock(Mutex);
+  CurrentLoop = NULL;
+  LoopFinished.wait(lock, [this] { return ActiveWorkers == 0; });
+}
+
+void ThreadPool::runChunks(Loop& loop)
+{
+  InsideParallelFor = true;
+  long begin;
+  while ((begin = loop.NextIndex.fetch_add(loop.GrainSize)) < loop.Count)
+  {
+    (*loop.Body)(begin, std::min(begin + loop.GrainSize, loop.Count));
+  }
+  InsideParallelFor = false;
+}
+
+void ThreadPool::workerMain()
+{
+  unsigned long                  seenGeneration = 0;
+  std::unique_lock< std::mutex > lock(Mutex);
+  while (true)
+  {
+    LoopStarted.wait(lock, [&] {
+      return Stopping || LoopGeneration != seenGeneration;
+    });
+    if (Stopping)
+    {
+      return;
+    }
+    seenGeneration = LoopGeneration;
+    Loop* loop     = CurrentLoop;
+    if (loop == NULL)
+    {
+      continue;
+    }
+
+    ActiveWorkers++;
+    lock.unlock();
+    runChunks(*loop);
+    lock.lock();
+    if (--ActiveWorkers == 0)
+    {
+      LoopFinished.notify_all();
+    }
+  }
+}
@@ -0,0 +1,150 @@
+/**
+ * @file WorkspaceCache.cpp
+ * @brief On-disk cache of generated workspace point sets and meshes.
+ *
+ */
+
+#include "WorkspaceCache/WorkspaceCache.hpp"
+#include "PointSetUtilities/PointSetUtilities.hpp"
+#include <cstdlib>
+#include <vtkCellArray.h>
+#include <vtkIdList.h>
+// QT Includes
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QStandardPaths>
+
+WorkspaceCache::WorkspaceCache(const QString& directory)
+  : Directory(directory.isEmpty() ? defaultDirectory() : directory)
+{
+}
+
+QString WorkspaceCache::defaultDirectory()
+{
+  const char* directory = getenv("NEUROROBOT_WORKSPACE_CACHE_DIR");
+  if (directory != NULL && directory[0] != '\0')
+  {
+    return QString::fromLocal8Bit(directory);
+  }
+  return QStandardPaths::writableLocation(
+           QStandardPaths::GenericCacheLocation) +
+         "/NeuroRobot/workspaces";
+}
+
+uint64_t WorkspaceCache::hash(const void* data, size_t size, uint64_t seed)
+{
+  const unsigned char* bytes = static_cast< const unsigned char* >(data);
+  for (size_t i = 0; i < size; i++)
+  {
+    seed ^= bytes[i];
+    seed *= 1099511628211ULL;
+  }
+  return seed;
+}
+
+QString WorkspaceCache::makeKey(const QString& name, uint64_t hash)
+{
+  return name + "_" + QString::number(hash, 16).rightJustified(16, '0');
+}
+
+QString WorkspaceCache::pointSetPath(const QString& key) const
+{
+  return Directory + "/" + key + ".points";
+}
+
+QString WorkspaceCache::meshPath(const QString& key) const
+{
+  return Directory + "/" + key + ".mesh";
+}
+
+bool WorkspaceCache::hasPointSet(const QString& key) const
+{
+  return QFileInfo::exists(pointSetPath(key));
+}
+
+bool WorkspaceCache::loadPointSet(const QString&    key,
+                                  Eigen::Matrix3Xf& pointSet) const
+{
+  QFile file(pointSetPath(key));
+  return file.open(QIODevice::ReadOnly) &&
+         PointSetUtilities::readPoints(file, pointSet);
+}
+
+bool WorkspaceCache::savePointSet(const QString&          key,
+                                  const Eigen::Matrix3Xf& pointSet) const
+{
+  return QDir().mkpath(Directory) &&
+         PointSetUtilities::saveToPoints(
+           pointSetPath(key).toLocal8Bit().constData(), pointSet);
+}
+
+std::shared_ptr< const MappedPointSet >
+  WorkspaceCache::mapPointSet(const QString& key) const
+{
+  std::shared_ptr< const MappedPointSet > pointSet =
+    std::make_shared< const MappedPointSet >(pointSetPath(key));
+  return pointSet->isValid() ? pointSet : nullptr;
+}
+
+vtkSmartPointer< vtkPolyData >
+  WorkspaceCache::loadMesh(const QString& key) const
+{
+  return MappedPointSet::getVTKMesh(
+    std::make_shared< const MappedPointSet >(meshPath(key)));
+}
+
+bool WorkspaceCache::saveMesh(const QString& key, vtkPolyData* mesh) const
+{
+  // Only the triangles of the mesh are stored, anything else fails
+  vtkCellArray* polys = mesh != NULL ? mesh->GetPolys() : NULL;
+  if (polys == NULL || polys->GetNumberOfCells() == 0 ||
+      polys->GetNumberOfCells() != mesh->GetNumberOfCells() ||
+      !QDir().mkpath(Directory))
+  {
+    return false;
+  }
+
+  Eigen::Matrix3Xf points(3, mesh->GetNumberOfPoints());
+  for (Eigen::Index i = 0; i < points.cols(); i++)
+  {
+    double point[3];
+    mesh->GetPoint(i, point);
+    points.col(i) = Eigen::Vector3d::Map(point).cast< float >();
+  }
+
+  Eigen::Matrix3Xi             triangles(3, polys->GetNumberOfCells());
+  vtkSmartPointer< vtkIdList > corners = vtkSmartPointer< vtkIdList >::New();
+  polys->InitTraversal();
+  for (Eigen::Index i = 0; polys->GetNextCell(corners); i++)
+  {
+    if (corners->GetNumberOfIds() != 3)
+    {
+      return false;
+    }
+    triangles.col(i) << corners->GetId(0), corners->GetId(1), corners->GetId(2);
+  }
+
+  return PointSetUtilities::saveToPoints(
+    meshPath(key).toLocal8Bit().constData(), points, triangles);
+}
+
+bool WorkspaceCache::clear() const
+{
+  QDir directory(Directory);
+  if (!directory.exists())
+  {
+    return true;
+  }
+
+  // Only the entries are removed, the directory may be shared
+  bool removed = true;
+  for (const QString& entry : directory.entryList(
+         QStringList() << "*.points"
+                       << "*.mesh",
+         QDir::Files))
+  {
+    removed = directory.remove(entry) && removed;
+  }
+  return removed;
+}
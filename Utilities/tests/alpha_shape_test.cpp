@@ -0,0 +1,50 @@
+#include "AlphaShape/AlphaShape.hpp"
+#include <cmath>
+#include <iostream>
+#include <vtkMassProperties.h>
+#include <vtkSmartPointer.h>
+
+// Thins out a densely sampled sphere and reconstructs its surface from the
+// samples
+int main(int argc, char** argv)
+{
+  const double pi     = 3.14159265358979323846;
+  const double radius = 20.;
+
+  // Sphere sampled every 0.5 mm or so
+  const int        no_of_rings = 128, no_of_points_per_ring = 256;
+  Eigen::Matrix3Xf sphere(3, no_of_rings * no_of_points_per_ring);
+  for (int r = 0; r < no_of_rings; r++)
+  {
+    const double polar = pi * (r + 0.5) / no_of_rings;
+    for (int p = 0; p < no_of_points_per_ring; p++)
+    {
+      const double azimuth = 2. * pi * p / no_of_points_per_ring;
+      sphere.col(r * no_of_points_per_ring + p) =
+        (radius * Eigen::Vector3d(std::sin(polar) * std::cos(azimuth),
+                                  std::sin(polar) * std::sin(azimuth),
+                                  std::cos(polar)))
+          .cast< float >();
+    }
+  }
+
+  const Eigen::Matrix3Xf samples = AlphaShape::poissonDiskSubset(sphere, 1000);
+  bool passed = samples.cols() > 900 && samples.cols() < 1100;
+
+  AlphaShape                     alphaShape;
+  vtkSmartPointer< vtkPolyData > surface = alphaShape.reconstruct(sphere);
+  vtkSmartPointer< vtkMassProperties > properties =
+    vtkSmartPointer< vtkMassProperties >::New();
+  properties->SetInputData(surface);
+  properties->Update();
+  // The surface covers the sphere, the faces of the flat tetrahedra between
+  // neighbouring samples may cover parts of it twice
+  const double expected = 4. * pi * radius * radius;
+  passed = passed && properties->GetSurfaceArea() > 0.8 * expected;
+
+  std::cout << "AlphaShape test " << (passed ? "passed" : "failed") << ": "
+            << samples.cols() << " samples, surface area "
+            << properties->GetSurfaceArea() << " mm^2, " << expected
+            << " expected" << std::endl;
+  return passed ? 0 : 1;
+}
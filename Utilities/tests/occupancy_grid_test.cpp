@@ -0,0 +1,111 @@
+#include "OccupancyGrid/OccupancyGrid.hpp"
+#include <cmath>
+#include <iostream>
+
+static const double pi = 3.14159265358979323846;
+
+// Sphere sampled along rings of equal polar angle
+static Eigen::Matrix3Xf SampleSphere(const Eigen::Vector3d& center,
+                                     double radius, int no_of_rings,
+                                     int no_of_points_per_ring)
+{
+  Eigen::Matrix3Xf sphere(3, no_of_rings * no_of_points_per_ring);
+  for (int r = 0; r < no_of_rings; r++)
+  {
+    const double polar = pi * (r + 0.5) / no_of_rings;
+    for (int p = 0; p < no_of_points_per_ring; p++)
+    {
+      const double azimuth = 2. * pi * p / no_of_points_per_ring;
+      sphere.col(r * no_of_points_per_ring + p) =
+        (center + radius * Eigen::Vector3d(std::sin(polar) * std::cos(azimuth),
+                                           std::sin(polar) * std::sin(azimuth),
+                                           std::cos(polar)))
+          .cast< float >();
+    }
+  }
+  return sphere;
+}
+
+// Fills a sampled sphere and compares the occupied voxels with the ball, and
+// checks that a sphere cut by the extent of the reference grid, on one side
+// or on all of them, is still filled.
+int main(int argc, char** argv)
+{
+  const double    radius = 20.;
+  Eigen::Vector3d center(3., -5., 10.);
+
+  // Sphere sampled every 2 mm or so
+  const Eigen::Matrix3Xf sphere = SampleSphere(center, radius, 32, 64);
+
+  // Reference grid of 1 x 1 x 2 mm voxels, its voxel 0 is at -50 mm
+  Eigen::Matrix4d ijkToPosition = Eigen::Matrix4d::Identity();
+  ijkToPosition.diagonal().head< 3 >() << 1., 1., 2.;
+  ijkToPosition.topRightCorner< 3, 1 >().setConstant(-50.);
+  const Eigen::Array3i lower = Eigen::Array3i::Zero();
+  const Eigen::Array3i upper(99, 99, 49);
+  // Number of voxels of the ball, the voxels of the sampled surface add a
+  // few percent
+  const double expected = 4. / 3. * pi * std::pow(radius, 3) / 2.;
+
+  OccupancyGrid grid(ijkToPosition, lower, upper, sphere, 5.);
+  grid.fill(5.);
+  const Eigen::Array3i centerVoxel =
+    ((center.array() + 50.) / Eigen::Array3d(1., 1., 2.))
+      .round()
+      .cast< int >() -
+    grid.getOffset();
+  const long centerIndex =
+    (long(centerVoxel(2)) * grid.getDimensions()(1) + centerVoxel(1)) *
+      grid.getDimensions()(0) +
+    centerVoxel(0);
+  bool passed = std::abs(grid.count() - expected) < 0.1 * expected &&
+                grid.getVoxels()[centerIndex] == 1 &&
+                grid.getVoxels()[0] == 0;
+
+  // Half of the sphere is outside the extent
+  const Eigen::Array3i cut(99, 99, 30);
+  OccupancyGrid        halfGrid(ijkToPosition, lower, cut, sphere, 5.);
+  halfGrid.fill(5.);
+  passed = passed &&
+           halfGrid.getOffset()(2) + halfGrid.getDimensions()(2) == 31 &&
+           halfGrid.count() > 0.4 * expected &&
+           halfGrid.count() < 0.6 * expected;
+
+  // A 50 mm sphere in 0.75 mm voxels, the extent of +-60 voxels around its
+  // center cuts it on all sides. The voxels of the extent whose center is in
+  // the ball should be occupied and the corners of the extent should not.
+  const double           largeRadius = 50., largeSpacing = 0.75;
+  const Eigen::Matrix3Xf largeSphere =
+    SampleSphere(Eigen::Vector3d::Zero(), largeRadius, 80, 160);
+  Eigen::Matrix4d largeIJKToPosition = Eigen::Matrix4d::Identity();
+  largeIJKToPosition.diagonal().head< 3 >().setConstant(largeSpacing);
+  const Eigen::Array3i largeLower = Eigen::Array3i::Constant(-60);
+  const Eigen::Array3i largeUpper = Eigen::Array3i::Constant(60);
+  OccupancyGrid        cutGrid(largeIJKToPosition, largeLower, largeUpper,
+                        largeSphere, 13.);
+  cutGrid.fill(13.);
+  long cutExpected = 0;
+  for (int k = -60; k <= 60; k++)
+  {
+    for (int j = -60; j <= 60; j++)
+    {
+      for (int i = -60; i <= 60; i++)
+      {
+        cutExpected += largeSpacing * Eigen::Vector3d(i, j, k).norm() <
+                       largeRadius;
+      }
+    }
+  }
+  const std::vector< unsigned char >& cutVoxels = cutGrid.getVoxels();
+  passed = passed && (cutGrid.getOffset() == largeLower).all() &&
+           (cutGrid.getDimensions() == 121).all() &&
+           std::abs(cutGrid.count() - cutExpected) < 0.05 * cutExpected &&
+           cutVoxels.front() == 0 && cutVoxels.back() == 0 &&
+           cutVoxels[cutVoxels.size() / 2] == 1;
+
+  std::cout << "OccupancyGrid test " << (passed ? "passed" : "failed") << ": "
+            << grid.count() << ", " << halfGrid.count() << " and "
+            << cutGrid.count() << " voxels, " << expected << " and "
+            << cutExpected << " expected" << std::endl;
+  return passed ? 0 : 1;
+}
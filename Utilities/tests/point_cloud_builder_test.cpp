@@ -0,0 +1,62 @@
+#include "PointCloudBuilder/PointCloudBuilder.hpp"
+#include <iostream>
+
+// Appends points past several reallocations, including points at the origin,
+// and checks that they are handed off unchanged and without a copy.
+int main(int argc, char** argv)
+{
+  const int no_of_points = 1000;
+  bool      passed       = true;
+
+  // Geometric growth from an empty builder. Every tenth point is the origin,
+  // which is a valid point of the set.
+  PointCloudBuilder builder;
+  for (int i = 0; i < no_of_points; i++)
+  {
+    if (i % 10 == 0)
+    {
+      builder.append(0.f, 0.f, 0.f);
+    }
+    else
+    {
+      builder.append(i, 2.f * i, -1.f * i);
+    }
+  }
+  Eigen::Matrix4d transformation_matrix = Eigen::Matrix4d::Identity();
+  transformation_matrix.block< 3, 1 >(0, 3) << 1., 2., 3.;
+  builder.appendTranslation(transformation_matrix);
+
+  Eigen::Matrix3Xf point_set = builder.release();
+  passed = passed && point_set.cols() == no_of_points + 1 && builder.empty();
+  for (int i = 0; passed && i < no_of_points; i++)
+  {
+    Eigen::Vector3f expected(0.f, 0.f, 0.f);
+    if (i % 10 != 0)
+    {
+      expected << i, 2.f * i, -1.f * i;
+    }
+    passed = point_set.col(i) == expected;
+  }
+  passed = passed && point_set.col(no_of_points) == Eigen::Vector3f(1, 2, 3);
+
+  // A set holding only the origin is not empty
+  PointCloudBuilder origin_only;
+  origin_only.append(Eigen::Vector3f::Zero());
+  passed = passed && origin_only.release().cols() == 1;
+
+  // With the count known upfront the points are handed off in place
+  PointCloudBuilder exact(no_of_points);
+  for (int i = 0; i < no_of_points; i++)
+  {
+    exact.append(i, i, i);
+  }
+  const float*     exact_data      = exact.data();
+  Eigen::Matrix3Xf exact_point_set = exact.release();
+  passed = passed && exact_point_set.data() == exact_data &&
+           exact_point_set.cols() == no_of_points;
+
+  std::cout << (passed ? "PointCloudBuilder test passed"
+                       : "PointCloudBuilder test failed")
+            << std::endl;
+  return passed ? 0 : 1;
+}
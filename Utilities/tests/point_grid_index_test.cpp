@@ -0,0 +1,61 @@
+#include "PointGridIndex/PointGridIndex.hpp"
+#include <cmath>
+#include <iostream>
+#include <limits>
+
+// Compares sphere queries against a scan of every point: the points of the
+// inner cells are inside, and every point inside is returned exactly once.
+int main(int argc, char** argv)
+{
+  const int        no_of_points = 5000;
+  Eigen::Matrix3Xf point_set =
+    50.f * Eigen::Matrix3Xf::Random(3, no_of_points);
+  // Points which are not finite are never returned
+  point_set(1, 10) = std::numeric_limits< float >::quiet_NaN();
+
+  PointGridIndex index(point_set, 4.);
+  bool           passed = index.size() == no_of_points - 1;
+  for (Eigen::Index i = 0; passed && i < index.size(); i++)
+  {
+    passed = index.getPoints().col(i) == point_set.col(index.getPointIndex(i));
+  }
+
+  const double radii[] = {0., 3., 20., 45., 200.};
+  for (int query = 0; passed && query < 50; query++)
+  {
+    const Eigen::Vector3d center = 60. * Eigen::Vector3d::Random();
+    const double          radius = radii[query % 5];
+
+    std::vector< PointGridIndex::Range > inside, crossing;
+    index.querySphere(center, radius, inside, crossing);
+
+    std::vector< int > found(no_of_points, 0);
+    for (const PointGridIndex::Range& range : inside)
+    {
+      for (Eigen::Index i = range.first; i < range.second; i++)
+      {
+        const Eigen::Vector3d point = index.getPoints().col(i).cast< double >();
+        passed = passed && (point - center).norm() <= radius;
+        found[index.getPointIndex(i)]++;
+      }
+    }
+    for (const PointGridIndex::Range& range : crossing)
+    {
+      for (Eigen::Index i = range.first; i < range.second; i++)
+      {
+        found[index.getPointIndex(i)]++;
+      }
+    }
+    for (int i = 0; passed && i < no_of_points; i++)
+    {
+      const bool is_inside =
+        (point_set.col(i).cast< double >() - center).norm() <= radius;
+      passed = found[i] <= 1 && (!is_inside || found[i] == 1);
+    }
+  }
+
+  std::cout << (passed ? "PointGridIndex test passed"
+                       : "PointGridIndex test failed")
+            << std::endl;
+  return passed ? 0 : 1;
+}
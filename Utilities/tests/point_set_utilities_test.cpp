@@ -0,0 +1,69 @@
+#include "PointSetUtilities/PointSetUtilities.hpp"
+#include <QTemporaryDir>
+#include <iostream>
+
+// Checks that the VTK point set shares the coordinates of the Eigen point set,
+// writes through to them and keeps them alive, and round trips the point set
+// and a mesh through a .points file
+int main(int argc, char** argv)
+{
+  const Eigen::Matrix3Xf expected = Eigen::Matrix3Xf::Random(3, 1000);
+
+  vtkSmartPointer< vtkPoints > vtkPointSet;
+  bool                         passed = true;
+  {
+    PointSetUtilities utils(expected);
+    vtkPointSet = utils.getVTKPointSet();
+    passed      = vtkPointSet->GetVoidPointer(0) ==
+             static_cast< const void* >(utils.getEigenPointSet().data());
+
+    // Writing a point through VTK writes it in the point set
+    const double moved[3] = {1., 2., 3.};
+    utils.getVTKPointSet()->SetPoint(0, moved);
+    passed = passed &&
+             utils.getEigenPointSet().col(0) == Eigen::Vector3f(1.f, 2.f, 3.f);
+    const double original[3] = {expected(0, 0), expected(1, 0), expected(2, 0)};
+    vtkPointSet->SetPoint(0, original);
+    passed = passed && utils.getEigenPointSet().col(0) == expected.col(0);
+
+    // Replacing the point set leaves the shared one alone
+    utils.setEigenPointSet(Eigen::Matrix3Xf::Zero(3, 10));
+    passed = passed && utils.getVTKPointSet()->GetNumberOfPoints() == 10;
+  }
+
+  passed = passed && vtkPointSet->GetNumberOfPoints() == expected.cols();
+  for (Eigen::Index i = 0; passed && i < expected.cols(); i++)
+  {
+    double point[3];
+    vtkPointSet->GetPoint(i, point);
+    passed = Eigen::Vector3d(point[0], point[1], point[2])
+               .isApprox(expected.col(i).cast< double >());
+  }
+
+  QTemporaryDir directory;
+  if (!directory.isValid())
+  {
+    std::cerr << "Could not create a temporary directory" << std::endl;
+    return 1;
+  }
+  const QByteArray path = (directory.path() + "/points.points").toLocal8Bit();
+  Eigen::Matrix3Xf loaded;
+  passed = passed && PointSetUtilities(expected).saveToPoints(path.data()) &&
+           PointSetUtilities::loadFromPoints(path.data(), loaded) &&
+           loaded == expected;
+
+  // The points and triangles of a mesh are mapped in place
+  const Eigen::Matrix3Xi triangles = Eigen::Matrix3Xi::Random(3, 100);
+  passed = passed &&
+           PointSetUtilities::saveToPoints(path.data(), expected, triangles) &&
+           PointSetUtilities::loadFromPoints(path.data(), loaded) &&
+           loaded == expected;
+
+  MappedPointSet mapped(QString::fromLocal8Bit(path));
+  passed = passed && mapped.isValid() && mapped.getPoints() == expected &&
+           mapped.getTriangles() == triangles;
+
+  std::cout << "PointSetUtilities test " << (passed ? "passed" : "failed")
+            << std::endl;
+  return passed ? 0 : 1;
+}
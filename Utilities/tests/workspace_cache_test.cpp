@@ -0,0 +1,96 @@
+#include "PointSetUtilities/PointSetUtilities.hpp"
+#include "WorkspaceCache/WorkspaceCache.hpp"
+#include <QFile>
+#include <QTemporaryDir>
+#include <iostream>
+#include <vtkCellArray.h>
+#include <vtkIdList.h>
+
+// Round trips a point set and a mesh through the cache and checks that
+// missing, truncated and cleared entries are not returned.
+int main(int argc, char** argv)
+{
+  QTemporaryDir directory;
+  if (!directory.isValid())
+  {
+    std::cerr << "Could not create a temporary directory" << std::endl;
+    return 1;
+  }
+  WorkspaceCache cache(directory.path());
+  bool           passed = true;
+
+  const uint64_t   hash      = WorkspaceCache::hash("workspace", 9);
+  const QString    key       = WorkspaceCache::makeKey("workspace", hash);
+  Eigen::Matrix3Xf point_set = Eigen::Matrix3Xf::Random(3, 1000);
+  Eigen::Matrix3Xf loaded;
+
+  passed = passed && !cache.hasPointSet(key);
+  passed = passed && !cache.loadPointSet(key, loaded);
+  passed = passed && cache.savePointSet(key, point_set);
+  passed = passed && cache.hasPointSet(key);
+  passed = passed && cache.loadPointSet(key, loaded) && loaded == point_set;
+  passed = passed && cache.mapPointSet(key) != nullptr &&
+           cache.mapPointSet(key)->getPoints() == point_set;
+
+  // A different key does not find the entry
+  const QString other_key = WorkspaceCache::makeKey("workspace", hash + 1);
+  passed = passed && !cache.loadPointSet(other_key, loaded);
+
+  // A truncated entry is rejected
+  QFile file(directory.path() + "/" + key + ".points");
+  passed = passed && file.resize(file.size() - 1);
+  passed = passed && !cache.loadPointSet(key, loaded);
+  passed = passed && cache.mapPointSet(key) == nullptr;
+
+  // The surface of a tetrahedron
+  vtkSmartPointer< vtkPoints > points = vtkSmartPointer< vtkPoints >::New();
+  points->SetDataTypeToFloat();
+  points->InsertNextPoint(0., 0., 0.);
+  points->InsertNextPoint(1., 0., 0.);
+  points->InsertNextPoint(0., 1., 0.);
+  points->InsertNextPoint(0., 0., 1.);
+  const vtkIdType faces[4][3] = {{0, 2, 1}, {0, 1, 3}, {0, 3, 2}, {1, 2, 3}};
+  vtkSmartPointer< vtkCellArray > polys =
+    vtkSmartPointer< vtkCellArray >::New();
+  for (const vtkIdType* face : faces)
+  {
+    polys->InsertNextCell(3, face);
+  }
+  vtkSmartPointer< vtkPolyData > mesh = vtkSmartPointer< vtkPolyData >::New();
+  mesh->SetPoints(points);
+  mesh->SetPolys(polys);
+
+  passed = passed && cache.loadMesh(key) == NULL;
+  passed = passed && cache.saveMesh(key, mesh);
+  vtkSmartPointer< vtkPolyData > loaded_mesh = cache.loadMesh(key);
+  passed = passed && loaded_mesh != NULL &&
+           loaded_mesh->GetNumberOfPoints() == 4 &&
+           loaded_mesh->GetNumberOfCells() == 4;
+  for (vtkIdType i = 0; passed && i < 4; i++)
+  {
+    double expected[3], point[3];
+    points->GetPoint(i, expected);
+    loaded_mesh->GetPoint(i, point);
+    passed = Eigen::Vector3d::Map(point) == Eigen::Vector3d::Map(expected);
+  }
+  vtkSmartPointer< vtkIdList > corners = vtkSmartPointer< vtkIdList >::New();
+  for (vtkIdType i = 0; passed && i < 4; i++)
+  {
+    loaded_mesh->GetCellPoints(i, corners);
+    passed = corners->GetNumberOfIds() == 3 &&
+             corners->GetId(0) == faces[i][0] &&
+             corners->GetId(1) == faces[i][1] &&
+             corners->GetId(2) == faces[i][2];
+  }
+
+  // Files which are still mapped cannot be removed on every platform
+  loaded_mesh = NULL;
+  passed      = passed && cache.savePointSet(key, point_set) && cache.clear();
+  passed      = passed && !cache.loadPointSet(key, loaded);
+  passed      = passed && cache.loadMesh(key) == NULL;
+
+  std::cout << (passed ? "WorkspaceCache test passed"
+                       : "WorkspaceCache test failed")
+            << std::endl;
+  return passed ? 0 : 1;
+}
@@ -63,12 +63,15 @@
 #include <vtkMath.h>
 #include <vtkNew.h>
 #include <vtkObjectFactory.h>
+#include <vtkOrientedImageData.h>
 #include <vtkPoints.h>
+#include <vtkSegmentationConverter.h>
 #include <vtkSmartPointer.h>
 #include <vtkTriangleFilter.h>
 #include <vtkXMLImageDataWriter.h>
 
 // STD includes
+#include <algorithm>
 #include <cassert>
 #include <chrono>
 #include <cmath>
@@ -89,12 +92,35 @@
 #include <itkLabelObject.h>
 #include <itkNiftiImageIO.h>
 
-#include <PointSetUtilities/PointSetUtilities.hpp>
+#include <AlphaShape/AlphaShape.hpp>
+#include <OccupancyGrid/OccupancyGrid.hpp>
 
 class qSlicerAbstractCoreModule;
 class vtkSlicerVolumeRenderingLogic;
 class vtkMRMLVolumeRenderingDisplayNode;
 
+// Alpha of the workspace meshes in percent of the diagonal of their bounding
+// box, and number of samples of the point sets they are reconstructed from
+static const double kWorkspaceAlphaPercentage = 5.;
+static const int    kWorkspaceMeshSamples     = 1000;
+// Bumped whenever the mesher changes its output for the same point set and
+// parameters, which invalidates the cached meshes. The meshlab script was 1.
+static const double kWorkspaceMesherVersion = 2.;
+
+// Gaps between the workspace samples closed when they are rasterized (mm),
+// close to the alpha of the workspace meshes
+static const double kOccupancyClosingRadius = 13.;
+
+// Hash of the parameters of a workspace mesh, those of its point set chained
+// with those of the mesher
+static uint64_t GetMeshParameterHash(uint64_t parameter_hash)
+{
+  const double parameters[] = {kWorkspaceMesherVersion,
+                               kWorkspaceAlphaPercentage,
+                               double(kWorkspaceMeshSamples)};
+  return WorkspaceCache::hash(parameters, sizeof(parameters), parameter_hash);
+}
+
 //----------------------------------------------------------------------------
 vtkStandardNewMacro(vtkSlicerWorkspaceGenerationLogic);
 
@@ -137,6 +163,8 @@ vtkSlicerWorkspaceGenerationLogic::vtkSlicerWorkspaceGenerationLogic()
                                vtkSlicerSegmentationsModuleLogic::SafeDownCast(
                                  this->SegmentationsModule->logic()) :
                                0;
+
+  this->SubWorkspaceKey = 0;
 }
 
 //----------------------------------------------------------------------------
@@ -858,7 +886,7 @@ bool vtkSlicerWorkspaceGenerationLogic::IdentifyBurrHole(
 
 // feature: #18 Generate subworkspace given markup points. @FaridTavakol
 //------------------------------------------------------------------------------
-void vtkSlicerWorkspaceGenerationLogic::UpdateSubWorkspace(
+bool vtkSlicerWorkspaceGenerationLogic::UpdateSubWorkspace(
   vtkMRMLWorkspaceGenerationNode* wsgn, Probe probe,
   vtkMatrix4x4* registration_matrix)
 {
@@ -869,7 +897,7 @@ void vtkSlicerWorkspaceGenerationLogic::UpdateSubWorkspace(
   if (entryPointNode == NULL)
   {
     qCritical() << Q_FUNC_INFO << ": Entry Point is empty";
-    return;
+    return false;
   }
 
   double* entryPoint = entryPointNode->GetNthControlPointPosition(0);
@@ -894,12 +922,28 @@ void vtkSlicerWorkspaceGenerationLogic::UpdateSubWorkspace(
   {
     qCritical() << Q_FUNC_INFO
                 << ": subworkspace generation model node is invalid";
-    return;
+    return false;
   }
 
   // Initialize NeuroKinematics
   NeuroKinematics        neuro_kinematics(&probe);
-  WorkspaceVisualization ws(neuro_kinematics);
+  WorkspaceVisualization ws(neuro_kinematics, GetWorkspaceResolution(wsgn));
+
+  // The sub-workspace only depends on the parameters, the entry point and the
+  // registration. Requesting it again without changing any of them keeps the
+  // current segment instead of sweeping and meshing the same workspace.
+  uint64_t sub_workspace_key = WorkspaceCache::hash(
+    entryPoint, 3 * sizeof(double), ws.GetParameterHash());
+  sub_workspace_key = WorkspaceCache::hash(
+    registration_matrix->GetData(), 16 * sizeof(double), sub_workspace_key);
+  if (sub_workspace_key == this->SubWorkspaceKey &&
+      segmentationNode == this->SubWorkspaceMeshSegmentationNode &&
+      segmentationNode->GetSegmentation()->GetSegment(
+        "sub_workspace_segment") != NULL)
+  {
+    qDebug() << Q_FUNC_INFO << ": Sub-workspace is up to date";
+    return false;
+  }
 
   std::chrono::_V2::system_clock::time_point start =
     std::chrono::high_resolution_clock::now();
@@ -926,7 +970,7 @@ void vtkSlicerWorkspaceGenerationLogic::UpdateSubWorkspace(
     wsNotReachableErrorModal.exec();
     // while (wsNotReachableModal.exec() == QDialog::Accepted)
 
-    return;
+    return false;
   }
 
   QString workspace_name = "sub_workspace";
@@ -937,10 +981,12 @@ void vtkSlicerWorkspaceGenerationLogic::UpdateSubWorkspace(
   if (!isWSLoadedState)
   {
     qCritical() << Q_FUNC_INFO << ": Workspace loading failed";
-    return;
+    return false;
   }
 
   this->SubWorkspaceMeshSegmentationNode = segmentationNode;
+  this->SubWorkspaceKey                  = sub_workspace_key;
+  return true;
 }
 
 //------------------------------------------------------------------------------
@@ -1124,223 +1170,527 @@ Eigen::Matrix4d
 }
 
 //------------------------------------------------------------------------------
-void vtkSlicerWorkspaceGenerationLogic::GenerateGeneralWorkspace(
-  vtkMRMLSegmentationNode* segmentationNode, Probe probe)
+WorkspaceResolution vtkSlicerWorkspaceGenerationLogic::GetWorkspaceResolution(
+  vtkMRMLWorkspaceGenerationNode* moduleNode)
+{
+  WorkspaceResolution resolution;
+  if (moduleNode == NULL)
+  {
+    return resolution;
+  }
+
+  resolution.axial           = moduleNode->GetAxialResolution();
+  resolution.lateral         = moduleNode->GetLateralResolution();
+  resolution.pitch           = moduleNode->GetPitchResolution();
+  resolution.yaw             = moduleNode->GetYawResolution();
+  resolution.probe_insertion = moduleNode->GetProbeInsertionResolution();
+  resolution.general_workspace_sides =
+    moduleNode->GetWorkspaceSidesResolution();
+  resolution.rcm_point_set     = moduleNode->GetRcmPointSetResolution();
+  resolution.surface_tolerance = moduleNode->GetSurfaceTolerance();
+  return resolution;
+}
+
+//------------------------------------------------------------------------------
+bool vtkSlicerWorkspaceGenerationLogic::GenerateGeneralWorkspace(
+  vtkMRMLSegmentationNode* segmentationNode, Probe probe,
+  const WorkspaceResolution& resolution, vtkMatrix4x4* occupancyRegistration,
+  int no_of_passes, const std::function< void() >& passCompleted)
 {
   qInfo() << Q_FUNC_INFO;
 
   if (segmentationNode == NULL)
   {
     qCritical() << Q_FUNC_INFO << ": output model node is invalid";
-    return;
+    return false;
   }
 
   // Initialize NeuroKinematics
-  NeuroKinematics        neuro_kinematics(&probe);
-  WorkspaceVisualization ws(neuro_kinematics);
-
-  std::chrono::_V2::system_clock::time_point start =
-    std::chrono::high_resolution_clock::now();
-  vtkSmartPointer< vtkPoints > workspacePointCloud =
-    vtkSmartPointer< vtkPoints >::New();
-  Eigen::Matrix3Xf general_workspace = ws.GetGeneralWorkspace();
-
-  QString workspace_name = "general_workspace";
+  NeuroKinematics neuro_kinematics(&probe);
 
-  bool isWSLoadedState = this->LoadWorkspaceAsSegmentation(
-    segmentationNode, workspace_name, general_workspace, &start);
+  QString workspace_name  = "general_workspace";
+  bool    isWSLoadedState = this->GenerateWorkspaceInPasses(
+    segmentationNode, workspace_name, neuro_kinematics, resolution,
+    [](WorkspaceVisualization& ws) { return ws.GetGeneralWorkspace(); },
+    occupancyRegistration, no_of_passes, passCompleted);
 
   if (!isWSLoadedState)
   {
     qCritical() << Q_FUNC_INFO << ": Workspace loading failed";
-    return;
+    return false;
   }
 
   this->WorkspaceMeshSegmentationNode = segmentationNode;
+  return true;
 }
 
 //------------------------------------------------------------------------------
-void vtkSlicerWorkspaceGenerationLogic::GenerateEPWorkspace(
-  vtkMRMLSegmentationNode* segmentationNode, Probe probe)
+bool vtkSlicerWorkspaceGenerationLogic::GenerateEPWorkspace(
+  vtkMRMLSegmentationNode* segmentationNode, Probe probe,
+  const WorkspaceResolution& resolution, vtkMatrix4x4* occupancyRegistration,
+  int no_of_passes, const std::function< void() >& passCompleted)
 {
   qInfo() << Q_FUNC_INFO;
 
   if (segmentationNode == NULL)
   {
     qCritical() << Q_FUNC_INFO << ": output model node is invalid";
-    return;
+    return false;
   }
 
   // Initialize NeuroKinematics
-  NeuroKinematics        neuro_kinematics(&probe);
-  WorkspaceVisualization ws(neuro_kinematics);
+  NeuroKinematics neuro_kinematics(&probe);
 
-  std::chrono::_V2::system_clock::time_point start =
-    std::chrono::high_resolution_clock::now();
-  vtkSmartPointer< vtkPoints > workspacePointCloud =
-    vtkSmartPointer< vtkPoints >::New();
-  Eigen::Matrix3Xf entry_point_workspace = ws.GetEntryPointWorkspace();
-
-  QString workspace_name = "entry_point_workspace";
-
-  bool isWSLoadedState = this->LoadWorkspaceAsSegmentation(
-    segmentationNode, workspace_name, entry_point_workspace, &start);
+  QString workspace_name  = "entry_point_workspace";
+  bool    isWSLoadedState = this->GenerateWorkspaceInPasses(
+    segmentationNode, workspace_name, neuro_kinematics, resolution,
+    [](WorkspaceVisualization& ws) { return ws.GetEntryPointWorkspace(); },
+    occupancyRegistration, no_of_passes, passCompleted);
 
   if (!isWSLoadedState)
   {
     qCritical() << Q_FUNC_INFO << ": Workspace loading failed";
-    return;
+    return false;
   }
 
   this->WorkspaceMeshSegmentationNode = segmentationNode;
+  return true;
 }
 
 //------------------------------------------------------------------------------
-bool vtkSlicerWorkspaceGenerationLogic::LoadWorkspaceAsSegmentation(
+bool vtkSlicerWorkspaceGenerationLogic::GenerateWorkspaceInPasses(
   vtkMRMLSegmentationNode* segmentationNode, QString& workspace_name,
-  Eigen::Matrix3Xf&                           workspace,
-  std::chrono::_V2::system_clock::time_point* start)
+  const NeuroKinematics& kinematics, const WorkspaceResolution& resolution,
+  const std::function< Eigen::Matrix3Xf(WorkspaceVisualization&) >&
+                                 generate_workspace,
+  vtkMatrix4x4*                  occupancyRegistration, int no_of_passes,
+  const std::function< void() >& passCompleted)
 {
-  auto checkpoint_workspace_gen = std::chrono::high_resolution_clock::now();
-  PointSetUtilities utils(workspace);
-
-  QString input_filename =
-    "WorkspaceGeneration/Resources/meshes/" + workspace_name + ".xyz";
-  QString output_filename =
-    "WorkspaceGeneration/Resources/meshes/" + workspace_name + ".ply";
-  QString mesh_generation_script_filename =
-    "WorkspaceGeneration/Resources/meshes/mesh_generation_script.mlx";
-  QFileInfo input_filepath(input_filename);
-  QFileInfo output_filepath(output_filename);
-  QFileInfo mesh_gen_filepath(mesh_generation_script_filename);
-  utils.saveToXyz(input_filepath.absoluteFilePath().toUtf8().data());
-
-  // Get environment variable for Meshlab Path
-  // Also set this path in your bashrc, or in the same terminal as this script
-  // export MESHLAB_BIN_DIR=~/meshlab/src/install/usr/bin/ OR
-  // export MESHLAB_BIN_DIR=/usr/bin/ if you have installed it using sudo
-  char* meshlab_dir_path;
-  meshlab_dir_path = getenv("MESHLAB_BIN_DIR");
-
-  if (meshlab_dir_path == NULL)
+  // Previews are pointless once the final point set is cached
+  WorkspaceVisualization final_ws(kinematics, resolution);
+  no_of_passes = std::max(no_of_passes, 1);
+  if (this->WorkspaceMeshCache.hasPointSet(
+        WorkspaceCache::makeKey(workspace_name, final_ws.GetParameterHash())))
   {
-    qCritical() << Q_FUNC_INFO
-                << ": Meshlab dir path is not in the environment";
+    no_of_passes = 1;
   }
 
-  QString meshlab_bin_path(meshlab_dir_path);
-  meshlab_bin_path += "meshlabserver";
+  // Every pass has twice the steps of the previous one along each joint
+  for (int pass = no_of_passes - 1; pass >= 0; pass--)
+  {
+    WorkspaceVisualization ws(
+      kinematics, WorkspaceVisualization::GetCoarseResolution(
+                    resolution, std::ldexp(1., pass)));
+    std::chrono::_V2::system_clock::time_point start =
+      std::chrono::high_resolution_clock::now();
 
-  // Calling Meshlab to create a PLY file from the general_workspace.xyz
-  QString generate_ws_command =
-    meshlab_bin_path + QString(" -i ") + input_filepath.absoluteFilePath() +
-    QString(" -o ") + output_filepath.absoluteFilePath() + QString(" -s ") +
-    mesh_gen_filepath.absoluteFilePath() +
-    QString(" 1> meshlab_output.log 2> meshlab_output_err.log");
+    // A failed pass leaves the previous preview, which is already registered
+    if (!this->UpdateWorkspaceSegment(
+          segmentationNode, workspace_name, ws.GetParameterHash(),
+          [&] { return generate_workspace(ws); }, occupancyRegistration,
+          &start, pass == 0))
+    {
+      qCritical() << Q_FUNC_INFO << ": Pass " << no_of_passes - pass
+                  << " of " << no_of_passes << " failed";
+      return false;
+    }
+    if (pass > 0 && passCompleted)
+    {
+      passCompleted();
+    }
+  }
 
-  qDebug() << Q_FUNC_INFO << ": Command is - " << generate_ws_command;
+  return true;
+}
 
-  std::system(generate_ws_command.toUtf8().data());
+//------------------------------------------------------------------------------
+bool vtkSlicerWorkspaceGenerationLogic::UpdateWorkspaceSegment(
+  vtkMRMLSegmentationNode* segmentationNode, QString& workspace_name,
+  uint64_t                                    parameter_hash,
+  const std::function< Eigen::Matrix3Xf() >&  generate_workspace,
+  vtkMatrix4x4*                               occupancyRegistration,
+  std::chrono::_V2::system_clock::time_point* start, bool use_cache)
+{
+  std::shared_ptr< const MappedPointSet > mapped;
+  Eigen::Matrix3Xf                        generated;
+  if (occupancyRegistration != NULL)
+  {
+    vtkSmartPointer< vtkOrientedImageData > workspaceLabelmap;
+    if (use_cache)
+    {
+      workspaceLabelmap = this->GenerateWorkspaceOccupancy(
+        this->GetCachedWorkspacePointSet(
+          WorkspaceCache::makeKey(workspace_name, parameter_hash),
+          generate_workspace, mapped, generated),
+        occupancyRegistration);
+    }
+    else
+    {
+      generated = generate_workspace();
+      workspaceLabelmap =
+        this->GenerateWorkspaceOccupancy(generated, occupancyRegistration);
+    }
+    return workspaceLabelmap != NULL &&
+           this->AddWorkspaceSegment(segmentationNode, workspace_name,
+                                     workspaceLabelmap);
+  }
 
-  auto checkpoint_meshlab = std::chrono::high_resolution_clock::now();
+  vtkSmartPointer< vtkPolyData > workspaceMesh;
+  if (use_cache)
+  {
+    workspaceMesh = this->GetCachedWorkspaceMesh(
+      workspace_name, parameter_hash, generate_workspace, start);
+  }
+  else
+  {
+    generated = generate_workspace();
+    workspaceMesh =
+      this->GenerateWorkspaceMesh(workspace_name, generated, start);
+  }
+  return workspaceMesh != NULL &&
+         this->AddWorkspaceSegment(segmentationNode, workspace_name,
+                                   workspaceMesh);
+}
 
-  auto duration_workspace_gen =
-    std::chrono::duration_cast< std::chrono::microseconds >(
-      checkpoint_workspace_gen - *start);
+//------------------------------------------------------------------------------
+vtkSmartPointer< vtkPolyData >
+  vtkSlicerWorkspaceGenerationLogic::GetCachedWorkspaceMesh(
+    QString& workspace_name, uint64_t parameter_hash,
+    const std::function< Eigen::Matrix3Xf() >& generate_workspace,
+    std::chrono::_V2::system_clock::time_point* start)
+{
+  // The mesh also depends on the mesher, the point set does not
+  QString mesh_key = WorkspaceCache::makeKey(
+    workspace_name, GetMeshParameterHash(parameter_hash));
 
-  auto duration_meshlab_gen =
-    std::chrono::duration_cast< std::chrono::microseconds >(
-      checkpoint_meshlab - checkpoint_workspace_gen);
+  vtkSmartPointer< vtkPolyData > workspaceMesh =
+    this->WorkspaceMeshCache.loadMesh(mesh_key);
+  if (workspaceMesh != NULL)
+  {
+    qDebug() << Q_FUNC_INFO << ": Loaded cached workspace " << mesh_key;
+    return workspaceMesh;
+  }
+
+  // The point set is cached on its own, so a failed meshing does not cost
+  // another sweep
+  std::shared_ptr< const MappedPointSet >    mapped;
+  Eigen::Matrix3Xf                           generated;
+  const Eigen::Map< const Eigen::Matrix3Xf > workspace =
+    this->GetCachedWorkspacePointSet(
+      WorkspaceCache::makeKey(workspace_name, parameter_hash),
+      generate_workspace, mapped, generated);
 
-  qDebug() << Q_FUNC_INFO << ": Time taken to generate workspace = "
-           << duration_workspace_gen.count();
+  workspaceMesh = this->GenerateWorkspaceMesh(workspace_name, workspace, start);
+  if (workspaceMesh != NULL &&
+      !this->WorkspaceMeshCache.saveMesh(mesh_key, workspaceMesh))
+  {
+    qWarning() << Q_FUNC_INFO << ": Failed to cache mesh " << mesh_key;
+  }
 
-  qDebug() << Q_FUNC_INFO
-           << ": Time taken to run meshlab server in background = "
-           << duration_meshlab_gen.count();
+  return workspaceMesh;
+}
 
-  if (this->ModelsLogic != NULL)
+//------------------------------------------------------------------------------
+Eigen::Map< const Eigen::Matrix3Xf >
+  vtkSlicerWorkspaceGenerationLogic::GetCachedWorkspacePointSet(
+    const QString&                             cache_key,
+    const std::function< Eigen::Matrix3Xf() >& generate_workspace,
+    std::shared_ptr< const MappedPointSet >&   mapped,
+    Eigen::Matrix3Xf&                          generated)
+{
+  // Mapping the entry only reads the pages of the points that are used
+  mapped = this->WorkspaceMeshCache.mapPointSet(cache_key);
+  if (mapped != nullptr)
   {
-    if (FILE* file =
-          fopen(output_filepath.absoluteFilePath().toUtf8().constData(), "r"))
-    {
-      qDebug() << Q_FUNC_INFO << ": workspace file exists";
-      fclose(file);
-    }
-    else
+    return mapped->getPoints();
+  }
+
+  generated = generate_workspace();
+  if (!this->WorkspaceMeshCache.savePointSet(cache_key, generated))
+  {
+    qWarning() << Q_FUNC_INFO << ": Failed to cache point set " << cache_key;
+  }
+  return Eigen::Map< const Eigen::Matrix3Xf >(generated.data(), 3,
+                                              generated.cols());
+}
+
+//------------------------------------------------------------------------------
+vtkSmartPointer< vtkOrientedImageData >
+  vtkSlicerWorkspaceGenerationLogic::GenerateWorkspaceOccupancy(
+    const Eigen::Ref< const Eigen::Matrix3Xf >& workspace,
+    vtkMatrix4x4*                               registration)
+{
+  vtkMRMLVolumeNode* inputVolumeNode =
+    this->WorkspaceGenerationNode != NULL ?
+      this->WorkspaceGenerationNode->GetInputVolumeNode() :
+      NULL;
+  if (inputVolumeNode == NULL || inputVolumeNode->GetImageData() == NULL)
+  {
+    qCritical() << Q_FUNC_INFO << ": No input volume to rasterize into";
+    return NULL;
+  }
+
+  // Voxels of the input volume, within the bounding box of the ROI
+  int extent[6];
+  inputVolumeNode->GetImageData()->GetExtent(extent);
+  Eigen::Array3i lower(extent[0], extent[2], extent[4]);
+  Eigen::Array3i upper(extent[1], extent[3], extent[5]);
+
+  vtkNew< vtkMatrix4x4 > ijkToRASMatrix;
+  inputVolumeNode->GetIJKToRASMatrix(ijkToRASMatrix);
+  const Eigen::Matrix4d ijkToRAS = convertToEigenMatrix(ijkToRASMatrix);
+
+  vtkMRMLAnnotationROINode* annotationROINode =
+    this->WorkspaceGenerationNode->GetAnnotationROINode();
+  if (annotationROINode != NULL)
+  {
+    double center[3], radius[3];
+    annotationROINode->GetXYZ(center);
+    annotationROINode->GetRadiusXYZ(radius);
+    const Eigen::Matrix4d rasToIJK = ijkToRAS.inverse();
+    Eigen::Array3d        roiLower = Eigen::Array3d::Constant(HUGE_VAL);
+    Eigen::Array3d        roiUpper = Eigen::Array3d::Constant(-HUGE_VAL);
+    for (int corner = 0; corner < 8; corner++)
     {
-      qCritical() << Q_FUNC_INFO << ": workspace file does not exist! exiting.";
-      return false;
+      Eigen::Vector4d position(1., 1., 1., 1.);
+      for (int a = 0; a < 3; a++)
+      {
+        position(a) = center[a] + ((corner >> a) & 1 ? radius[a] : -radius[a]);
+      }
+      const Eigen::Array3d ijk = (rasToIJK * position).head< 3 >().array();
+      roiLower                 = roiLower.min(ijk);
+      roiUpper                 = roiUpper.max(ijk);
     }
+    lower = lower.max(roiLower.floor().cast< int >());
+    upper = upper.min(roiUpper.ceil().cast< int >());
+  }
 
-    this->ModelsLogic->SetMRMLScene(this->GetMRMLScene());
-    vtkMRMLModelNode* workspaceModelNode = this->ModelsLogic->AddModel(
-      output_filepath.absoluteFilePath().toUtf8().data(),
-      vtkMRMLStorageNode::RAS);
+  // The workspace is in the frame of the robot, the registration to RAS is
+  // applied to the segmentation afterwards
+  const Eigen::Matrix4d ijkToRobot =
+    convertToEigenMatrix(registration).inverse() * ijkToRAS;
+  OccupancyGrid grid(ijkToRobot, lower, upper, workspace,
+                     kOccupancyClosingRadius);
+  grid.fill(kOccupancyClosingRadius);
+  if (grid.count() == 0)
+  {
+    qWarning() << Q_FUNC_INFO << ": Workspace is outside the input volume";
+  }
 
-    if (workspaceModelNode == NULL)
+  vtkSmartPointer< vtkOrientedImageData > labelmap =
+    vtkSmartPointer< vtkOrientedImageData >::New();
+  const Eigen::Array3i first = grid.getOffset();
+  const Eigen::Array3i last  = first + grid.getDimensions() - 1;
+  labelmap->SetExtent(first(0), last(0), first(1), last(1), first(2), last(2));
+  labelmap->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+  if (!grid.getVoxels().empty())
+  {
+    std::copy(grid.getVoxels().begin(), grid.getVoxels().end(),
+              static_cast< unsigned char* >(labelmap->GetScalarPointer()));
+  }
+
+  vtkNew< vtkMatrix4x4 > imageToWorld;
+  for (int i = 0; i < 4; i++)
+  {
+    for (int j = 0; j < 4; j++)
     {
-      qCritical() << Q_FUNC_INFO << ": Failed to load workspace as model";
-      return false;
+      imageToWorld->SetElement(i, j, ijkToRobot(i, j));
     }
+  }
+  labelmap->SetImageToWorldMatrix(imageToWorld);
+
+  return labelmap;
+}
+
+//------------------------------------------------------------------------------
+bool vtkSlicerWorkspaceGenerationLogic::LoadWorkspaceAsSegmentation(
+  vtkMRMLSegmentationNode* segmentationNode, QString& workspace_name,
+  Eigen::Matrix3Xf&                           workspace,
+  std::chrono::_V2::system_clock::time_point* start)
+{
+  vtkSmartPointer< vtkPolyData > workspaceMesh =
+    this->GenerateWorkspaceMesh(workspace_name, workspace, start);
+  if (workspaceMesh == NULL)
+  {
+    return false;
+  }
+
+  return this->AddWorkspaceSegment(segmentationNode, workspace_name,
+                                   workspaceMesh);
+}
+
+//------------------------------------------------------------------------------
+vtkSmartPointer< vtkPolyData >
+  vtkSlicerWorkspaceGenerationLogic::GenerateWorkspaceMesh(
+    QString&                                    workspace_name,
+    const Eigen::Ref< const Eigen::Matrix3Xf >& workspace,
+    std::chrono::_V2::system_clock::time_point* start)
+{
+  auto checkpoint_workspace_gen = std::chrono::high_resolution_clock::now();
 
-    vtkNew< vtkPolyData > modelPolyData;
-    modelPolyData->DeepCopy(workspaceModelNode->GetPolyData());
+  AlphaShape alphaShape(kWorkspaceAlphaPercentage, kWorkspaceMeshSamples);
+  vtkSmartPointer< vtkPolyData > workspaceMesh =
+    alphaShape.reconstruct(workspace);
+
+  auto checkpoint_mesh_gen = std::chrono::high_resolution_clock::now();
+
+  if (start != nullptr)
+  {
+    auto duration_workspace_gen =
+      std::chrono::duration_cast< std::chrono::microseconds >(
+        checkpoint_workspace_gen - *start);
+    qDebug() << Q_FUNC_INFO << ": Time taken to generate workspace = "
+             << duration_workspace_gen.count();
+  }
 
-    this->GetMRMLScene()->RemoveReferencesToNode(workspaceModelNode);
-    this->GetMRMLScene()->RemoveNode(workspaceModelNode);
+  auto duration_mesh_gen =
+    std::chrono::duration_cast< std::chrono::microseconds >(
+      checkpoint_mesh_gen - checkpoint_workspace_gen);
 
-    std::string segment_name =
-      QString(workspace_name + QString("_segment")).toUtf8().data();
+  qDebug() << Q_FUNC_INFO << ": Time taken to mesh " << workspace_name << " = "
+           << duration_mesh_gen.count();
 
-    vtkSmartPointer< vtkSegment > segment =
-      segmentationNode->GetSegmentation()->GetSegment(segment_name);
+  if (workspaceMesh->GetNumberOfCells() == 0)
+  {
+    qCritical() << Q_FUNC_INFO << ": Failed to mesh " << workspace_name;
+    return NULL;
+  }
 
+  return workspaceMesh;
+}
+
+//------------------------------------------------------------------------------
+bool vtkSlicerWorkspaceGenerationLogic::AddWorkspaceSegment(
+  vtkMRMLSegmentationNode* segmentationNode, const QString& workspace_name,
+  vtkPolyData* workspaceMesh)
+{
+  std::string segment_name =
+    QString(workspace_name + QString("_segment")).toUtf8().data();
+  const std::string closed_surface_name =
+    vtkSegmentationConverter::GetSegmentationClosedSurfaceRepresentationName();
+
+  vtkSegmentation* segmentation  = segmentationNode->GetSegmentation();
+  vtkSegment*      segment       = segmentation->GetSegment(segment_name);
+  vtkPolyData*     closedSurface = NULL;
+  if (segment != NULL &&
+      segmentation->GetMasterRepresentationName() == closed_surface_name)
+  {
+    closedSurface = vtkPolyData::SafeDownCast(
+      segment->GetRepresentation(closed_surface_name));
+  }
+
+  // The observers of the segmentation are notified once, when it is updated
+  int disabledModify = segmentationNode->StartModify();
+  if (closedSurface != NULL)
+  {
+    // The mesh is handed over to the segment without copying its points and
+    // cells. Its modified event has the segmentation convert the other
+    // representations again, the segment and its display are kept.
+    closedSurface->ShallowCopy(workspaceMesh);
+  }
+  else
+  {
     if (segment != NULL)
     {
       qDebug() << Q_FUNC_INFO << ": Removing previous segment";
-      segmentationNode->GetSegmentation()->RemoveSegment(segment);
+      segmentation->RemoveSegment(segment);
     }
 
     segmentationNode->SetMasterRepresentationToClosedSurface();
-    segmentationNode->AddSegmentFromClosedSurfaceRepresentation(modelPolyData,
+    segmentationNode->AddSegmentFromClosedSurfaceRepresentation(workspaceMesh,
                                                                 segment_name);
+  }
+  segmentationNode->EndModify(disabledModify);
 
-    // Attach a display node if needed
-    vtkMRMLSegmentationDisplayNode* displayNode =
-      vtkMRMLSegmentationDisplayNode::SafeDownCast(
-        segmentationNode->GetDisplayNode());
-    if (displayNode == NULL)
-    {
-      qWarning() << Q_FUNC_INFO
-                 << ": Display node is null, creating a new one ";
+  this->UpdateWorkspaceSegmentationDisplay(segmentationNode);
+  return true;
+}
 
-      segmentationNode->CreateDefaultDisplayNodes();
-      displayNode = vtkMRMLSegmentationDisplayNode::SafeDownCast(
-        segmentationNode->GetDisplayNode());
-    }
+//------------------------------------------------------------------------------
+bool vtkSlicerWorkspaceGenerationLogic::AddWorkspaceSegment(
+  vtkMRMLSegmentationNode* segmentationNode, const QString& workspace_name,
+  vtkOrientedImageData* workspaceLabelmap)
+{
+  std::string segment_name =
+    QString(workspace_name + QString("_segment")).toUtf8().data();
+  const std::string labelmap_name =
+    vtkSegmentationConverter::GetSegmentationBinaryLabelmapRepresentationName();
 
-    if (displayNode)
+  vtkSegmentation*      segmentation = segmentationNode->GetSegmentation();
+  vtkSegment*           segment      = segmentation->GetSegment(segment_name);
+  vtkOrientedImageData* labelmap     = NULL;
+  // A labelmap shared with other segments holds their voxels as well
+  if (segment != NULL &&
+      segmentation->GetMasterRepresentationName() == labelmap_name &&
+      segmentation->GetNumberOfSegments() == 1)
+  {
+    labelmap = vtkOrientedImageData::SafeDownCast(
+      segment->GetRepresentation(labelmap_name));
+  }
+
+  // The observers of the segmentation are notified once, when it is updated
+  int disabledModify = segmentationNode->StartModify();
+  if (labelmap != NULL)
+  {
+    // The segment takes the voxels and the geometry of the new labelmap, in
+    // the frame of the robot like a new segment. Resampling it into the
+    // segment would register it twice, the segment is already registered.
+    labelmap->ShallowCopy(workspaceLabelmap);
+  }
+  else
+  {
+    if (segment != NULL)
     {
-      std::string name =
-        std::string(segmentationNode->GetName()).append("SegmentationDisplay");
-      displayNode->SetName(name.c_str());
-      displayNode->SetColor(1, 1, 0);
-      displayNode->Visibility2DOn();
-      displayNode->Visibility3DOn();
-      // displayNode->SetSliceDisplayModeToIntersection();
-      // displayNode->SetSliceIntersectionVisibility(true);
-      // displayNode->SetVisibility(true);
-      displayNode->SetSliceIntersectionThickness(2);
-      // qDebug() << Q_FUNC_INFO
-      //          << displayNode->GetSliceDisplayModeAsString(
-      //               displayNode->GetSliceDisplayMode());
+      qDebug() << Q_FUNC_INFO << ": Removing previous segment";
+      segmentation->RemoveSegment(segment);
     }
+
+    // The labelmap is the master, the slice views show it without conversion
+    segmentationNode->SetMasterRepresentationToBinaryLabelmap();
+    segmentationNode->AddSegmentFromBinaryLabelmapRepresentation(
+      workspaceLabelmap, segment_name);
   }
+  segmentationNode->EndModify(disabledModify);
 
+  this->UpdateWorkspaceSegmentationDisplay(segmentationNode);
   return true;
 }
 
+//------------------------------------------------------------------------------
+void vtkSlicerWorkspaceGenerationLogic::UpdateWorkspaceSegmentationDisplay(
+  vtkMRMLSegmentationNode* segmentationNode)
+{
+  // Attach a display node if needed
+  vtkMRMLSegmentationDisplayNode* displayNode =
+    vtkMRMLSegmentationDisplayNode::SafeDownCast(
+      segmentationNode->GetDisplayNode());
+  if (displayNode == NULL)
+  {
+    qWarning() << Q_FUNC_INFO << ": Display node is null, creating a new one ";
+
+    segmentationNode->CreateDefaultDisplayNodes();
+    displayNode = vtkMRMLSegmentationDisplayNode::SafeDownCast(
+      segmentationNode->GetDisplayNode());
+  }
+
+  if (displayNode)
+  {
+    std::string name =
+      std::string(segmentationNode->GetName()).append("SegmentationDisplay");
+    displayNode->SetName(name.c_str());
+    displayNode->SetColor(1, 1, 0);
+    displayNode->Visibility2DOn();
+    displayNode->Visibility3DOn();
+    // displayNode->SetSliceDisplayModeToIntersection();
+    // displayNode->SetSliceIntersectionVisibility(true);
+    // displayNode->SetVisibility(true);
+    displayNode->SetSliceIntersectionThickness(2);
+    // qDebug() << Q_FUNC_INFO
+    //          << displayNode->GetSliceDisplayModeAsString(
+    //               displayNode->GetSliceDisplayMode());
+  }
+}
+
 //------------------------------------------------------------------------------
 vtkMRMLSegmentationNode*
   vtkSlicerWorkspaceGenerationLogic::getWorkspaceMeshSegmentationNode()
@@ -75,6 +75,8 @@
 
 // STD includes
 #include <cstdlib>
+#include <functional>
+#include <memory>
 
 // Eigen includes
 #include <eigen3/Eigen/Core>
@@ -82,6 +84,10 @@
 // Neurorobot includes
 #include "WorkspaceVisualization/WorkspaceVisualization.hpp"
 
+// Utilities includes
+#include "PointSetUtilities/PointSetUtilities.hpp"
+#include "WorkspaceCache/WorkspaceCache.hpp"
+
 // Isosurface creation
 #include <vtkContourFilter.h>
 #include <vtkExtractVOI.h>
@@ -96,6 +102,7 @@
 
 class vtkMRMLWorkspaceGenerationNode;
 class vtkMRMLSegmentationNode;
+class vtkOrientedImageData;
 class vtkPolyData;
 
 /// \ingroup Slicer_QtModules_ExtensionTemplate
@@ -127,8 +134,8 @@ public:
   // Update Markup Fiducial nodes for entry point and target point
   void UpdateMarkupFiducialNodes();
 
-  // Update the subworkspace
-  void UpdateSubWorkspace(vtkMRMLWorkspaceGenerationNode*, Probe probe,
+  // Update the subworkspace, returns true if its segment was regenerated
+  bool UpdateSubWorkspace(vtkMRMLWorkspaceGenerationNode*, Probe probe,
                           vtkMatrix4x4* registration_matrix);
 
   // Identify the Burr Hole
@@ -141,12 +148,28 @@ public:
   // Convert vtkMatrix to eigen Matrix
   static Eigen::Matrix4d convertToEigenMatrix(vtkMatrix4x4* vtkMat);
 
-  // Generate General Workspace
-  void GenerateGeneralWorkspace(vtkMRMLSegmentationNode* segmentationNode,
-                                Probe                    probe);
-  // Generate Entry Point Workspace
-  void GenerateEPWorkspace(vtkMRMLSegmentationNode* segmentationNode,
-                           Probe                    probe);
+  // Sampling resolution of the workspaces set in the module node
+  static WorkspaceResolution
+    GetWorkspaceResolution(vtkMRMLWorkspaceGenerationNode* moduleNode);
+
+  // Generate General Workspace. Given the registration of the robot to RAS,
+  // it is generated as its voxel occupancy in the input volume. With several
+  // passes, coarser previews replace the segment first, passCompleted is
+  // called after each of them. Returns false if the workspace could not be
+  // generated, the segment is then left as the last pass which was.
+  bool GenerateGeneralWorkspace(
+    vtkMRMLSegmentationNode* segmentationNode, Probe probe,
+    const WorkspaceResolution& resolution = WorkspaceResolution(),
+    vtkMatrix4x4*              occupancyRegistration = NULL,
+    int                        no_of_passes = 1,
+    const std::function< void() >& passCompleted = std::function< void() >());
+  // Generate Entry Point Workspace, see GenerateGeneralWorkspace
+  bool GenerateEPWorkspace(
+    vtkMRMLSegmentationNode* segmentationNode, Probe probe,
+    const WorkspaceResolution& resolution = WorkspaceResolution(),
+    vtkMatrix4x4*              occupancyRegistration = NULL,
+    int                        no_of_passes = 1,
+    const std::function< void() >& passCompleted = std::function< void() >());
 
   // Getters
   vtkSlicerVolumeRenderingLogic* getVolumeRenderingLogic();
@@ -204,6 +227,70 @@ protected:
     Eigen::Matrix3Xf&                           workspace,
     std::chrono::_V2::system_clock::time_point* start = nullptr);
 
+  // Mesh a workspace point set with an alpha shape, NULL if meshing failed
+  vtkSmartPointer< vtkPolyData > GenerateWorkspaceMesh(
+    QString&                                    workspace_name,
+    const Eigen::Ref< const Eigen::Matrix3Xf >& workspace,
+    std::chrono::_V2::system_clock::time_point* start = nullptr);
+
+  // Generates a workspace at increasing resolutions, each pass halving the
+  // steps of the next one, see GenerateGeneralWorkspace
+  bool GenerateWorkspaceInPasses(
+    vtkMRMLSegmentationNode* segmentationNode, QString& workspace_name,
+    const NeuroKinematics& kinematics, const WorkspaceResolution& resolution,
+    const std::function< Eigen::Matrix3Xf(WorkspaceVisualization&) >&
+                                   generate_workspace,
+    vtkMatrix4x4*                  occupancyRegistration, int no_of_passes,
+    const std::function< void() >& passCompleted);
+
+  // Replace the segment of a workspace with its mesh, or with its voxel
+  // occupancy given the registration of the robot. Without use_cache it is
+  // generated and left out of the cache, as the previews are not worth keeping.
+  bool UpdateWorkspaceSegment(
+    vtkMRMLSegmentationNode* segmentationNode, QString& workspace_name,
+    uint64_t                                    parameter_hash,
+    const std::function< Eigen::Matrix3Xf() >&  generate_workspace,
+    vtkMatrix4x4*                               occupancyRegistration,
+    std::chrono::_V2::system_clock::time_point* start     = nullptr,
+    bool                                        use_cache = true);
+
+  // Mesh of a workspace from the cache, generated and cached if missing
+  vtkSmartPointer< vtkPolyData > GetCachedWorkspaceMesh(
+    QString& workspace_name, uint64_t parameter_hash,
+    const std::function< Eigen::Matrix3Xf() >& generate_workspace,
+    std::chrono::_V2::system_clock::time_point* start = nullptr);
+
+  // Point set of a workspace mapped from the cache, generated and cached if
+  // missing. It stays valid as long as mapped, or generated if it could not be
+  // mapped, is not released.
+  Eigen::Map< const Eigen::Matrix3Xf > GetCachedWorkspacePointSet(
+    const QString&                             cache_key,
+    const std::function< Eigen::Matrix3Xf() >& generate_workspace,
+    std::shared_ptr< const MappedPointSet >&   mapped,
+    Eigen::Matrix3Xf&                          generated);
+
+  // Voxel occupancy of a workspace in the input volume, within the ROI if
+  // there is one, NULL without input volume
+  vtkSmartPointer< vtkOrientedImageData > GenerateWorkspaceOccupancy(
+    const Eigen::Ref< const Eigen::Matrix3Xf >& workspace,
+    vtkMatrix4x4*                               registration);
+
+  // Replace the segment of a workspace with the given mesh, which is shared
+  // rather than copied. An existing closed surface segment keeps its node and
+  // display, only its geometry is replaced.
+  bool AddWorkspaceSegment(vtkMRMLSegmentationNode* segmentationNode,
+                           const QString&           workspace_name,
+                           vtkPolyData*             workspaceMesh);
+  // Replace the segment of a workspace with the given labelmap, which is
+  // shared rather than copied. An existing labelmap segment, alone in its
+  // segmentation, takes its voxels and geometry in place.
+  bool AddWorkspaceSegment(vtkMRMLSegmentationNode* segmentationNode,
+                           const QString&           workspace_name,
+                           vtkOrientedImageData*    workspaceLabelmap);
+  // Show a workspace segmentation in the 2D and 3D views
+  void UpdateWorkspaceSegmentationDisplay(
+    vtkMRMLSegmentationNode* segmentationNode);
+
   // Parameter Nodes
   vtkMRMLWorkspaceGenerationNode* WorkspaceGenerationNode;
 
@@ -215,6 +302,9 @@ protected:
   vtkMRMLSegmentationNode* WorkspaceMeshSegmentationNode;
   vtkMRMLSegmentationNode* EPWorkspaceMeshSegmentationNode;
   vtkMRMLSegmentationNode* SubWorkspaceMeshSegmentationNode;
+  // Hash of the parameters, entry point and registration of the segment of
+  // SubWorkspaceMeshSegmentationNode
+  uint64_t SubWorkspaceKey;
 
   // Display Nodes
   vtkMRMLVolumeRenderingDisplayNode* InputVolumeRenderingDisplayNode;
@@ -243,6 +333,9 @@ protected:
   // Burr Hole Display Node
   vtkMRMLSegmentationDisplayNode* BurrHoleSegmentationDisplayNode;
 
+  // Cache of the general and entry point workspaces
+  WorkspaceCache WorkspaceMeshCache;
+
 private:
   vtkSlicerWorkspaceGenerationLogic(
     const vtkSlicerWorkspaceGenerationLogic&);               // Not implemented
@@ -138,6 +138,18 @@ vtkMRMLWorkspaceGenerationNode::vtkMRMLWorkspaceGenerationNode()
   double center[3]       = {0.0, 0.0, 0.0};
   this->BurrHoleRadius   = 1.0;
 
+  // Default resolutions of WorkspaceVisualization
+  this->AxialResolution          = 65.0;
+  this->LateralResolution        = 15.0;
+  this->PitchResolution          = 10.0;
+  this->YawResolution            = 15.0;
+  this->ProbeInsertionResolution = 10.0;
+  this->WorkspaceSidesResolution = 5.0;
+  this->RcmPointSetResolution    = 30.0;
+  this->SurfaceTolerance         = 0.0;
+  this->OccupancyOutput          = false;
+  this->ProgressivePasses        = 1;
+
   std::copy(this->BurrHoleCenter, this->BurrHoleCenter + 3, center);
   this->SetBurrHoleParameters(vtkVector3d(this->BurrHoleCenter),
                               this->BurrHoleRadius);
@@ -160,6 +172,16 @@ void vtkMRMLWorkspaceGenerationNode::WriteXML(ostream& of, int nIndent)
   vtkMRMLWriteXMLBooleanMacro(BurrHoleDetected, BurrHoleDetected);
   vtkMRMLWriteXMLVectorMacro(BurrHoleCenter, BurrHoleCenter, double, 3);
   vtkMRMLWriteXMLFloatMacro(BurrHoleRadius, BurrHoleRadius);
+  vtkMRMLWriteXMLFloatMacro(AxialResolution, AxialResolution);
+  vtkMRMLWriteXMLFloatMacro(LateralResolution, LateralResolution);
+  vtkMRMLWriteXMLFloatMacro(PitchResolution, PitchResolution);
+  vtkMRMLWriteXMLFloatMacro(YawResolution, YawResolution);
+  vtkMRMLWriteXMLFloatMacro(ProbeInsertionResolution, ProbeInsertionResolution);
+  vtkMRMLWriteXMLFloatMacro(WorkspaceSidesResolution, WorkspaceSidesResolution);
+  vtkMRMLWriteXMLFloatMacro(RcmPointSetResolution, RcmPointSetResolution);
+  vtkMRMLWriteXMLFloatMacro(SurfaceTolerance, SurfaceTolerance);
+  vtkMRMLWriteXMLBooleanMacro(OccupancyOutput, OccupancyOutput);
+  vtkMRMLWriteXMLIntMacro(ProgressivePasses, ProgressivePasses);
   // vtkMRMLWriteXMLIntMacro(InputNodeType, InputNodeType);
   vtkMRMLWriteXMLEndMacro();
 }
@@ -177,6 +199,16 @@ void vtkMRMLWorkspaceGenerationNode::ReadXMLAttributes(const char** atts)
   vtkMRMLReadXMLBooleanMacro(BurrHoleDetected, BurrHoleDetected);
   vtkMRMLReadXMLVectorMacro(BurrHoleCenter, BurrHoleCenter, double, 3);
   vtkMRMLReadXMLFloatMacro(BurrHoleRadius, BurrHoleRadius);
+  vtkMRMLReadXMLFloatMacro(AxialResolution, AxialResolution);
+  vtkMRMLReadXMLFloatMacro(LateralResolution, LateralResolution);
+  vtkMRMLReadXMLFloatMacro(PitchResolution, PitchResolution);
+  vtkMRMLReadXMLFloatMacro(YawResolution, YawResolution);
+  vtkMRMLReadXMLFloatMacro(ProbeInsertionResolution, ProbeInsertionResolution);
+  vtkMRMLReadXMLFloatMacro(WorkspaceSidesResolution, WorkspaceSidesResolution);
+  vtkMRMLReadXMLFloatMacro(RcmPointSetResolution, RcmPointSetResolution);
+  vtkMRMLReadXMLFloatMacro(SurfaceTolerance, SurfaceTolerance);
+  vtkMRMLReadXMLBooleanMacro(OccupancyOutput, OccupancyOutput);
+  vtkMRMLReadXMLIntMacro(ProgressivePasses, ProgressivePasses);
   // vtkMRMLReadXMLBooleanMacro(InputNodeType, InputNodeType);
   vtkMRMLReadXMLEndMacro();
   this->EndModify(disabledModify);
@@ -194,6 +226,16 @@ void vtkMRMLWorkspaceGenerationNode::Copy(vtkMRMLNode* anode)
   vtkMRMLCopyBooleanMacro(BurrHoleDetected);
   vtkMRMLCopyVectorMacro(BurrHoleCenter, double, 3);
   vtkMRMLCopyFloatMacro(BurrHoleRadius);
+  vtkMRMLCopyFloatMacro(AxialResolution);
+  vtkMRMLCopyFloatMacro(LateralResolution);
+  vtkMRMLCopyFloatMacro(PitchResolution);
+  vtkMRMLCopyFloatMacro(YawResolution);
+  vtkMRMLCopyFloatMacro(ProbeInsertionResolution);
+  vtkMRMLCopyFloatMacro(WorkspaceSidesResolution);
+  vtkMRMLCopyFloatMacro(RcmPointSetResolution);
+  vtkMRMLCopyFloatMacro(SurfaceTolerance);
+  vtkMRMLCopyBooleanMacro(OccupancyOutput);
+  vtkMRMLCopyIntMacro(ProgressivePasses);
   // vtkMRMLCopyBooleanMacro(InputNodeType);
   vtkMRMLCopyEndMacro();
   this->EndModify(disabledModify);
@@ -210,6 +252,16 @@ void vtkMRMLWorkspaceGenerationNode::PrintSelf(ostream& os, vtkIndent indent)
   vtkMRMLPrintBooleanMacro(BurrHoleDetected);
   vtkMRMLPrintVectorMacro(BurrHoleCenter, double, 3);
   vtkMRMLPrintFloatMacro(BurrHoleRadius);
+  vtkMRMLPrintFloatMacro(AxialResolution);
+  vtkMRMLPrintFloatMacro(LateralResolution);
+  vtkMRMLPrintFloatMacro(PitchResolution);
+  vtkMRMLPrintFloatMacro(YawResolution);
+  vtkMRMLPrintFloatMacro(ProbeInsertionResolution);
+  vtkMRMLPrintFloatMacro(WorkspaceSidesResolution);
+  vtkMRMLPrintFloatMacro(RcmPointSetResolution);
+  vtkMRMLPrintFloatMacro(SurfaceTolerance);
+  vtkMRMLPrintBooleanMacro(OccupancyOutput);
+  vtkMRMLPrintIntMacro(ProgressivePasses);
   // vtkMRMLPrintBooleanMacro(InputNodeType);
   vtkMRMLPrintEndMacro();
 }
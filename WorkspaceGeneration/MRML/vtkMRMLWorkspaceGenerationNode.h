@@ -137,6 +137,33 @@ public:
   vtkGetMacro(BurrHoleRadius, float);
   vtkSetMacro(BurrHoleRadius, float);
 
+  // Number of steps each joint range is split into when sampling workspaces
+  vtkGetMacro(AxialResolution, double);
+  vtkSetMacro(AxialResolution, double);
+  vtkGetMacro(LateralResolution, double);
+  vtkSetMacro(LateralResolution, double);
+  vtkGetMacro(PitchResolution, double);
+  vtkSetMacro(PitchResolution, double);
+  vtkGetMacro(YawResolution, double);
+  vtkSetMacro(YawResolution, double);
+  vtkGetMacro(ProbeInsertionResolution, double);
+  vtkSetMacro(ProbeInsertionResolution, double);
+  vtkGetMacro(WorkspaceSidesResolution, double);
+  vtkSetMacro(WorkspaceSidesResolution, double);
+  vtkGetMacro(RcmPointSetResolution, double);
+  vtkSetMacro(RcmPointSetResolution, double);
+  // Surface tolerance (mm) of the adaptive sampling, 0 samples uniformly
+  vtkGetMacro(SurfaceTolerance, double);
+  vtkSetMacro(SurfaceTolerance, double);
+  // Generate the workspaces as voxel occupancy labelmaps of the input volume
+  // instead of meshes
+  vtkGetMacro(OccupancyOutput, bool);
+  vtkSetMacro(OccupancyOutput, bool);
+  // Number of passes of doubling resolution the workspaces are generated in,
+  // the coarser ones are shown while the next one is generated
+  vtkGetMacro(ProgressivePasses, int);
+  vtkSetMacro(ProgressivePasses, int);
+
 protected:
   // Constructor/destructor methods
   vtkMRMLWorkspaceGenerationNode();
@@ -184,6 +211,16 @@ private:
   double             BurrHoleCenter[3];
   float              BurrHoleRadius;
   BurrHoleParameters BurrHoleParams;
+  double             AxialResolution;
+  double             LateralResolution;
+  double             PitchResolution;
+  double             YawResolution;
+  double             ProbeInsertionResolution;
+  double             WorkspaceSidesResolution;
+  double             RcmPointSetResolution;
+  double             SurfaceTolerance;
+  bool               OccupancyOutput;
+  int                ProgressivePasses;
 
   // int InputNodeType;
 };
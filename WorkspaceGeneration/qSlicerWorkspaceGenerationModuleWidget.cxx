@@ -794,15 +794,33 @@ void qSlicerWorkspaceGenerationModuleWidget::onGenerateWorkspaceClick()
            << " C= " << probe._cannulaToTreatment
            << " D= " << probe._robotToTreatmentAtHome;
 
-  d->logic()->GenerateGeneralWorkspace(workspaceMeshSegmentationNode,
-                                       d->ProbeSpecs.convertToProbe());
+  this->updateResolutionMRMLFromGUI(workspaceGenerationNode);
+  // The previews are registered and drawn while the next pass is generated
+  this->enableAllWidgets(false);
+  bool isWorkspaceGenerated = d->logic()->GenerateGeneralWorkspace(
+    workspaceMeshSegmentationNode, d->ProbeSpecs.convertToProbe(),
+    vtkSlicerWorkspaceGenerationLogic::GetWorkspaceResolution(
+      workspaceGenerationNode),
+    workspaceGenerationNode->GetOccupancyOutput() ?
+      registration_matrix.GetPointer() :
+      NULL,
+    workspaceGenerationNode->GetProgressivePasses(), [&]() {
+      workspaceMeshSegmentationNode->ApplyTransformMatrix(registration_matrix);
+      QCoreApplication::processEvents();
+    });
+  this->enableAllWidgets(true);
 
   // d->WorkspaceMeshSegmentationNode =
   // d->logic()->getWorkspaceMeshSegmentationNode();
   d->WorkspaceMeshSegmentationNode = workspaceMeshSegmentationNode;
   d->WorkspaceModelSelector__3_2->setCurrentNode(workspaceMeshSegmentationNode);
 
-  workspaceMeshSegmentationNode->ApplyTransformMatrix(registration_matrix);
+  // The segment is left as it was, or as its last registered preview, when
+  // the generation failed
+  if (isWorkspaceGenerated)
+  {
+    workspaceMeshSegmentationNode->ApplyTransformMatrix(registration_matrix);
+  }
 
   this->updateGUIFromMRML();
 }
@@ -1008,8 +1026,22 @@ void qSlicerWorkspaceGenerationModuleWidget::
   vtkNew< vtkMatrix4x4 > registration_matrix;
   registration_matrix->DeepCopy(d->RegistrationMatrix__3_10->values().data());
 
-  d->logic()->GenerateEPWorkspace(ePWorkspaceMeshSegmentationNode,
-                                  d->ProbeSpecs.convertToProbe());
+  this->updateResolutionMRMLFromGUI(workspaceGenerationNode);
+  // The previews are registered and drawn while the next pass is generated
+  this->enableAllWidgets(false);
+  bool isWorkspaceGenerated = d->logic()->GenerateEPWorkspace(
+    ePWorkspaceMeshSegmentationNode, d->ProbeSpecs.convertToProbe(),
+    vtkSlicerWorkspaceGenerationLogic::GetWorkspaceResolution(
+      workspaceGenerationNode),
+    workspaceGenerationNode->GetOccupancyOutput() ?
+      registration_matrix.GetPointer() :
+      NULL,
+    workspaceGenerationNode->GetProgressivePasses(), [&]() {
+      ePWorkspaceMeshSegmentationNode->ApplyTransformMatrix(
+        registration_matrix);
+      QCoreApplication::processEvents();
+    });
+  this->enableAllWidgets(true);
   // ,
   // d->WorkspaceMeshRegistrationMatrix);
 
@@ -1019,7 +1051,12 @@ void qSlicerWorkspaceGenerationModuleWidget::
   d->EntryPointWorkspaceModelSelector__3_13->setCurrentNode(
     ePWorkspaceMeshSegmentationNode);
 
-  ePWorkspaceMeshSegmentationNode->ApplyTransformMatrix(registration_matrix);
+  // The segment is left as it was, or as its last registered preview, when
+  // the generation failed
+  if (isWorkspaceGenerated)
+  {
+    ePWorkspaceMeshSegmentationNode->ApplyTransformMatrix(registration_matrix);
+  }
 
   this->updateGUIFromMRML();
 }
@@ -1773,9 +1810,10 @@ void qSlicerWorkspaceGenerationModuleWidget::onGenerateSubWorkspaceClick()
   vtkNew< vtkMatrix4x4 > registration_matrix;
   registration_matrix->DeepCopy(d->RegistrationMatrix__3_10->values().data());
 
-  d->logic()->UpdateSubWorkspace(workspaceGenerationNode,
-                                 d->ProbeSpecs.convertToProbe(),
-                                 registration_matrix);
+  this->updateResolutionMRMLFromGUI(workspaceGenerationNode);
+  bool isSubWorkspaceGenerated = d->logic()->UpdateSubWorkspace(
+    workspaceGenerationNode, d->ProbeSpecs.convertToProbe(),
+    registration_matrix);
   // ,
   // d->WorkspaceMeshRegistrationMatrix);
 
@@ -1785,8 +1823,12 @@ void qSlicerWorkspaceGenerationModuleWidget::onGenerateSubWorkspaceClick()
   d->SubWorkspaceMeshSelector__5_4->setCurrentNode(
     subWorkspaceMeshSegmentationNode);
 
-  d->SubWorkspaceMeshSegmentationNode->ApplyTransformMatrix(
-    registration_matrix);
+  // A segment which was kept is already registered
+  if (isSubWorkspaceGenerated)
+  {
+    d->SubWorkspaceMeshSegmentationNode->ApplyTransformMatrix(
+      registration_matrix);
+  }
 
   this->updateGUIFromMRML();
 }
@@ -2208,6 +2250,37 @@ void qSlicerWorkspaceGenerationModuleWidget::setCheckState(ctkPushButton* btn,
   btn->setStyleSheet(color);
 }
 
+//-----------------------------------------------------------------------------
+void qSlicerWorkspaceGenerationModuleWidget::updateResolutionMRMLFromGUI(
+  vtkMRMLWorkspaceGenerationNode* workspaceGenerationNode)
+{
+  Q_D(qSlicerWorkspaceGenerationModuleWidget);
+
+  // Single modified event for all the resolutions
+  int disabledModify = workspaceGenerationNode->StartModify();
+  workspaceGenerationNode->SetAxialResolution(
+    d->AxialResolutionSpinBox->value());
+  workspaceGenerationNode->SetLateralResolution(
+    d->LateralResolutionSpinBox->value());
+  workspaceGenerationNode->SetPitchResolution(
+    d->PitchResolutionSpinBox->value());
+  workspaceGenerationNode->SetYawResolution(
+    d->YawResolutionSpinBox->value());
+  workspaceGenerationNode->SetProbeInsertionResolution(
+    d->ProbeInsertionResolutionSpinBox->value());
+  workspaceGenerationNode->SetWorkspaceSidesResolution(
+    d->WorkspaceSidesResolutionSpinBox->value());
+  workspaceGenerationNode->SetRcmPointSetResolution(
+    d->RcmPointSetResolutionSpinBox->value());
+  workspaceGenerationNode->SetSurfaceTolerance(
+    d->SurfaceToleranceSpinBox->value());
+  workspaceGenerationNode->SetOccupancyOutput(
+    d->OccupancyOutputCheckBox->isChecked());
+  workspaceGenerationNode->SetProgressivePasses(
+    d->ProgressivePassesSpinBox->value());
+  workspaceGenerationNode->EndModify(disabledModify);
+}
+
 //-----------------------------------------------------------------------------
 void qSlicerWorkspaceGenerationModuleWidget::updateGUIFromMRML()
 {
@@ -2232,6 +2305,28 @@ void qSlicerWorkspaceGenerationModuleWidget::updateGUIFromMRML()
 
   this->enableAllWidgets(true);
 
+  // Sampling resolution
+  d->AxialResolutionSpinBox->setValue(
+    workspaceGenerationNode->GetAxialResolution());
+  d->LateralResolutionSpinBox->setValue(
+    workspaceGenerationNode->GetLateralResolution());
+  d->PitchResolutionSpinBox->setValue(
+    workspaceGenerationNode->GetPitchResolution());
+  d->YawResolutionSpinBox->setValue(
+    workspaceGenerationNode->GetYawResolution());
+  d->ProbeInsertionResolutionSpinBox->setValue(
+    workspaceGenerationNode->GetProbeInsertionResolution());
+  d->WorkspaceSidesResolutionSpinBox->setValue(
+    workspaceGenerationNode->GetWorkspaceSidesResolution());
+  d->RcmPointSetResolutionSpinBox->setValue(
+    workspaceGenerationNode->GetRcmPointSetResolution());
+  d->SurfaceToleranceSpinBox->setValue(
+    workspaceGenerationNode->GetSurfaceTolerance());
+  d->OccupancyOutputCheckBox->setChecked(
+    workspaceGenerationNode->GetOccupancyOutput());
+  d->ProgressivePassesSpinBox->setValue(
+    workspaceGenerationNode->GetProgressivePasses());
+
   // d->InputVolumeNodeSelector__2_2->blockSignals(true);
   // Set mrml scene in input volume node selector
   d->InputVolumeNodeSelector__2_2->setMRMLScene(this->mrmlScene());
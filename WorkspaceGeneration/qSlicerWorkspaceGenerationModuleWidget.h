@@ -132,6 +132,7 @@ protected slots:
   void markupPlacedEventHandler(vtkMRMLMarkupsNode*);
 
   void updateGUIFromMRML();
+  void updateResolutionMRMLFromGUI(vtkMRMLWorkspaceGenerationNode*);
 
   void blockAllSignals(bool block);
   void enableAllWidgets(bool enable);